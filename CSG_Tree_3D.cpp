@@ -0,0 +1,353 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   CSG_Tree_3D.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "CSG_Tree_3D.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include "Intersect_Meshes_3D.h"
+#include "Parallel_Queries.h"
+#include "Point_Index.h"
+#include "shapes.h"
+
+namespace VCAD_lib
+{
+    CSG_Tree_3D::Content::Content(const Node_Type t) : type(t), values(), ids() {}
+    
+    void CSG_Tree_3D::Content::add_point(const Point_3D& pt)
+    {
+        add_value(pt.get_x());
+        add_value(pt.get_y());
+        add_value(pt.get_z());
+    }
+    
+    const bool CSG_Tree_3D::Content::operator==(const Content& content) const
+    {
+        return type == content.type && values == content.values && ids == content.ids;
+    }
+    
+    const size_t CSG_Tree_3D::Content_Hasher::operator()(const Content& content) const
+    {
+        hash<Measurement> value_hasher;
+        hash<int> id_hasher;
+        size_t hash_value = id_hasher(content.type);
+        for (vector<Measurement>::const_iterator it = content.values.begin(); it != content.values.end(); ++it)
+            hash_combine(hash_value, value_hasher(*it));
+        for (vector<int>::const_iterator it = content.ids.begin(); it != content.ids.end(); ++it)
+            hash_combine(hash_value, id_hasher(*it));
+        return hash_value;
+    }
+    
+    CSG_Tree_3D::Evaluator::Evaluator(const CSG_Tree_3D& t, const vector<int>& i, 
+            const unsigned int threads) : tree(t), ids(i), intersect_threads(threads) {}
+    
+    const Mesh_3D CSG_Tree_3D::Evaluator::operator()(const size_t index) const
+    {
+        const Content& content(*tree.contents[ids[index]]);
+        const vector<Measurement>& v(content.values);
+        Mesh_3D mesh(tree.precision);
+        switch (content.type)
+        {
+            case mesh_node:
+            {
+                mesh = Mesh_3D(v[0], vector<Measurement>(v.begin() + 2, v.end()), content.ids);
+                mesh.set_weld_points(v[1] != 0);
+                break;
+            }
+            case cuboid_node:
+                m_cuboid(mesh, v[0], v[1], v[2], v[3] != 0, Point_3D(v[4], v[5], v[6]));
+                break;
+            case cylinder_node:
+                m_cylinder(mesh, v[0], v[1], v[2], static_cast<int>(v[3]), v[4] != 0, 
+                        Point_3D(v[5], v[6], v[7]));
+                break;
+            case e_cylinder_node:
+                m_e_cylinder(mesh, v[0], v[1], v[2], v[3], v[4], static_cast<int>(v[5]), v[6] != 0, 
+                        Point_3D(v[7], v[8], v[9]));
+                break;
+            case sphere_node:
+                m_sphere(mesh, v[0], static_cast<int>(v[1]), Point_3D(v[2], v[3], v[4]));
+                break;
+            case ellipsoid_node:
+                m_ellipsoid(mesh, v[0], v[1], v[2], static_cast<int>(v[3]), Point_3D(v[4], v[5], v[6]));
+                break;
+            case transform_node:
+                mesh = tree.meshes.find(content.ids[0])->second;
+                mesh.transform(Transform_3D(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], 
+                        v[8], v[9], v[10], v[11]));
+                break;
+            case difference_node:
+                Intersect_Meshes_3D(intersect_threads).difference(tree.meshes.find(content.ids[0])->second, 
+                        tree.meshes.find(content.ids[1])->second, mesh);
+                break;
+            case intersection_node:
+                Intersect_Meshes_3D(intersect_threads).intersection(tree.meshes.find(content.ids[0])->second, 
+                        tree.meshes.find(content.ids[1])->second, mesh);
+                break;
+            case merge_node:
+                Intersect_Meshes_3D(intersect_threads).merge(tree.meshes.find(content.ids[0])->second, 
+                        tree.meshes.find(content.ids[1])->second, mesh);
+                break;
+        }
+        return mesh;
+    }
+    
+    CSG_Tree_3D::CSG_Tree_3D(const Measurement prec, const unsigned int threads) : 
+            precision(Mesh_3D(prec).get_precision()), num_threads(threads), nodes(), 
+            content_ids(), contents(), meshes() {}
+    
+    CSG_Tree_3D::CSG_Tree_3D() : precision(Mesh_3D().get_precision()), num_threads(0), nodes(), 
+            content_ids(), contents(), meshes() {}
+    
+    const int CSG_Tree_3D::add_mesh(const Mesh_3D& mesh)
+    {
+        Content content(mesh_node);
+        content.add_value(mesh.get_precision());
+        content.add_value(mesh.get_weld_points() ? 1 : 0);
+        content.values.reserve(2 + 3 * (mesh.point_end() - mesh.point_begin()));
+        for (Mesh_3D::const_point_iterator it = mesh.point_begin(); it != mesh.point_end(); ++it)
+            content.add_point(**it);
+        content.ids.reserve(3 * mesh.size());
+        for (Mesh_3D::const_facet_iterator it = mesh.facet_begin(); it != mesh.facet_end(); ++it)
+        {
+            content.ids.push_back(it->get_p1_index());
+            content.ids.push_back(it->get_p2_index());
+            content.ids.push_back(it->get_p3_index());
+        }
+        
+        const int node(add_node(content));
+        const int id(nodes[node]);
+        try
+        {
+            // the mesh is its own result
+            if (meshes.find(id) == meshes.end())
+                meshes.insert(pair<int, Mesh_3D>(id, mesh));
+        }
+        catch (...)
+        {
+            nodes.pop_back();
+            throw;
+        }
+        return node;
+    }
+    
+    const int CSG_Tree_3D::add_cuboid(const Measurement x_length, const Measurement y_length, 
+            const Measurement z_length, const bool center, const Point_3D& origin)
+    {
+        Content content(cuboid_node);
+        content.add_value(x_length);
+        content.add_value(y_length);
+        content.add_value(z_length);
+        content.add_value(center ? 1 : 0);
+        content.add_point(origin);
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_cylinder(const Measurement b_radius, const Measurement t_radius, 
+            const Measurement height, const int steps_per_quarter, const bool center, 
+            const Point_3D& origin)
+    {
+        Content content(cylinder_node);
+        content.add_value(b_radius);
+        content.add_value(t_radius);
+        content.add_value(height);
+        content.add_value(steps_per_quarter);
+        content.add_value(center ? 1 : 0);
+        content.add_point(origin);
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_e_cylinder(const Measurement b_x_radius, const Measurement b_y_radius, 
+            const Measurement t_x_radius, const Measurement t_y_radius, const Measurement height, 
+            const int steps_per_quarter, const bool center, const Point_3D& origin)
+    {
+        Content content(e_cylinder_node);
+        content.add_value(b_x_radius);
+        content.add_value(b_y_radius);
+        content.add_value(t_x_radius);
+        content.add_value(t_y_radius);
+        content.add_value(height);
+        content.add_value(steps_per_quarter);
+        content.add_value(center ? 1 : 0);
+        content.add_point(origin);
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_sphere(const Measurement radius, const int steps_per_quarter, 
+            const Point_3D& origin)
+    {
+        Content content(sphere_node);
+        content.add_value(radius);
+        content.add_value(steps_per_quarter);
+        content.add_point(origin);
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_ellipsoid(const Measurement x_radius, const Measurement y_radius, 
+            const Measurement z_radius, const int steps_per_quarter, const Point_3D& origin)
+    {
+        Content content(ellipsoid_node);
+        content.add_value(x_radius);
+        content.add_value(y_radius);
+        content.add_value(z_radius);
+        content.add_value(steps_per_quarter);
+        content.add_point(origin);
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_transform(const int node, const Transform_3D& t)
+    {
+        Content content(transform_node);
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+                content.add_value(t.get(row, col));
+        }
+        content.ids.push_back(node_content(node));
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_difference(const int node1, const int node2)
+    {
+        Content content(difference_node);
+        content.ids.push_back(node_content(node1));
+        content.ids.push_back(node_content(node2));
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_intersection(const int node1, const int node2)
+    {
+        Content content(intersection_node);
+        content.ids.push_back(node_content(node1));
+        content.ids.push_back(node_content(node2));
+        return add_node(content);
+    }
+    
+    const int CSG_Tree_3D::add_merge(const int node1, const int node2)
+    {
+        Content content(merge_node);
+        content.ids.push_back(node_content(node1));
+        content.ids.push_back(node_content(node2));
+        return add_node(content);
+    }
+    
+    void CSG_Tree_3D::evaluate(const int node, Mesh_3D& result)
+    {
+        const int id(node_content(node));
+        vector<vector<int>> levels;
+        unordered_map<int, int> id_levels;
+        add_to_levels(id, levels, id_levels);
+        
+        // the nodes in a level only use meshes from lower levels, so they 
+        // can be calculated at the same time
+        for (vector<vector<int>>::iterator level = levels.begin(); level != levels.end(); ++level)
+        {
+            sort(level->begin(), level->end());
+            // a single node uses the threads to intersect its meshes instead
+            const unsigned int intersect_threads(level->size() == 1 ? num_threads : 1);
+            vector<Mesh_3D> level_meshes;
+            run_queries(Evaluator(*this, *level, intersect_threads), level->size(), level_meshes, 
+                    num_threads, 1);
+            for (vector<int>::size_type i = 0; i < level->size(); ++i)
+                meshes.insert(pair<int, Mesh_3D>((*level)[i], move(level_meshes[i])));
+        }
+        result = meshes.find(id)->second;
+    }
+    
+    void CSG_Tree_3D::clear()
+    {
+        nodes.clear();
+    }
+    
+    void CSG_Tree_3D::clear_meshes()
+    {
+        meshes.clear();
+    }
+    
+    void CSG_Tree_3D::remove_unused_meshes()
+    {
+        // the nodes a node uses are also nodes, so the used content ids are 
+        // the node content ids
+        vector<bool> used(contents.size(), false);
+        for (vector<int>::const_iterator it = nodes.begin(); it != nodes.end(); ++it)
+            used[*it] = true;
+        
+        vector<int> unused;
+        for (unordered_map<int, Mesh_3D>::const_iterator it = meshes.begin(); it != meshes.end(); ++it)
+        {
+            if (!used[it->first])
+                unused.push_back(it->first);
+        }
+        for (vector<int>::const_iterator it = unused.begin(); it != unused.end(); ++it)
+            meshes.erase(*it);
+        
+        // forget unused content too, since mesh content can be large
+        for (int id = 0; id < static_cast<int>(contents.size()); ++id)
+        {
+            if (!used[id] && contents[id] != 0)
+            {
+                content_ids.erase(*contents[id]);
+                contents[id] = 0;
+            }
+        }
+    }
+    
+    const int CSG_Tree_3D::add_node(const Content& content)
+    {
+        nodes.reserve(nodes.size() + 1);
+        contents.reserve(contents.size() + 1);
+        pair<unordered_map<Content, int, Content_Hasher>::iterator, bool> inserted(
+                content_ids.insert(pair<Content, int>(content, contents.size())));
+        if (inserted.second)
+            contents.push_back(&inserted.first->first);
+        nodes.push_back(inserted.first->second);
+        return nodes.size() - 1;
+    }
+    
+    const int CSG_Tree_3D::node_content(const int node) const
+    {
+        if (node < 0 || node >= static_cast<int>(nodes.size()))
+            throw out_of_range("CSG node index out of range");
+        return nodes[node];
+    }
+    
+    const int CSG_Tree_3D::add_to_levels(const int id, vector<vector<int>>& levels, 
+            unordered_map<int, int>& id_levels) const
+    {
+        if (meshes.find(id) != meshes.end())
+            return -1;
+        unordered_map<int, int>::const_iterator found(id_levels.find(id));
+        if (found != id_levels.end())
+            return found->second;
+        
+        int level(0);
+        const Content& content(*contents[id]);
+        if (content.type != mesh_node) // mesh node ids are point indices
+        {
+            for (vector<int>::const_iterator it = content.ids.begin(); it != content.ids.end(); ++it)
+                level = max(level, add_to_levels(*it, levels, id_levels) + 1);
+        }
+        if (static_cast<int>(levels.size()) <= level)
+            levels.resize(level + 1);
+        levels[level].push_back(id);
+        id_levels[id] = level;
+        return level;
+    }
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   CSG_Tree_3D.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef CSG_TREE_3D_H
+#define CSG_TREE_3D_H
+
+#include <unordered_map>
+#include <vector>
+#include "Point_3D.h"
+#include "Mesh_3D.h"
+#include "Transform_3D.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+
+    /*
+     * A constructive solid geometry model.  Each node is a shape (a mesh or
+     * one of the shapes.h shapes), a transform of another node, or the
+     * difference, intersection or merge of two other nodes.  The add methods
+     * return the index of the new node to use in later nodes.  A node can be
+     * used by any number of other nodes.
+     *
+     * The mesh of every node that is evaluated is kept under the content of
+     * the node: its type, its values and the content of the nodes it uses.
+     * Nodes with the same content share one mesh, so only nodes that changed
+     * or use a node that changed are calculated again.  clear removes the
+     * nodes but keeps the meshes, so a model can be built again from the
+     * start after a change and only the changed branches are calculated.
+     * Nodes that do not depend on each other are calculated on separate
+     * threads.
+     */
+    class CSG_Tree_3D {
+    public:
+        typedef Point_3D::Measurement Measurement;
+        typedef vector<int>::size_type size_type;
+
+        /*
+         * precision is used for the shapes and the difference, intersection
+         * and merge results.  num_threads is the number of threads to
+         * evaluate nodes on (0 uses the number of hardware threads).
+         *
+         * exception safety: strong guarantee - invalid_argument if precision is less than or equal to zero
+         */
+        explicit CSG_Tree_3D(const Measurement prec, const unsigned int threads = 0);
+        // uses the Mesh_3D default precision
+        // exception safety: strong guarantee
+        CSG_Tree_3D();
+        // number of nodes
+        // exception safety: no throw
+        size_type size() const { return nodes.size(); }
+        // exception safety: no throw
+        bool empty() const { return nodes.empty(); }
+        /*
+         * shape nodes.  The values are the same as the shapes.h functions.
+         *
+         * exception safety: strong guarantee
+         */
+        const int add_mesh(const Mesh_3D& mesh);
+        const int add_cuboid(const Measurement x_length, const Measurement y_length, 
+                const Measurement z_length, const bool center=false, 
+                const Point_3D& origin=Point_3D(0,0,0));
+        const int add_cylinder(const Measurement b_radius, const Measurement t_radius, 
+                const Measurement height, const int steps_per_quarter, const bool center=false, 
+                const Point_3D& origin=Point_3D(0,0,0));
+        const int add_e_cylinder(const Measurement b_x_radius, const Measurement b_y_radius, 
+                const Measurement t_x_radius, const Measurement t_y_radius, 
+                const Measurement height, const int steps_per_quarter, const bool center=false, 
+                const Point_3D& origin=Point_3D(0,0,0));
+        const int add_sphere(const Measurement radius, const int steps_per_quarter, 
+                const Point_3D& origin=Point_3D(0,0,0));
+        const int add_ellipsoid(const Measurement x_radius, const Measurement y_radius, 
+                const Measurement z_radius, const int steps_per_quarter, 
+                const Point_3D& origin=Point_3D(0,0,0));
+        /*
+         * node with t applied to the mesh of node
+         *
+         * exception safety: strong guarantee - out_of_range if node is not a node index
+         */
+        const int add_transform(const int node, const Transform_3D& t);
+        /*
+         * nodes that combine two nodes like the Intersect_Meshes_3D methods
+         * with the same names.  add_difference subtracts node2 from node1.
+         *
+         * exception safety: strong guarantee - out_of_range if a node is not a node index
+         */
+        const int add_difference(const int node1, const int node2);
+        const int add_intersection(const int node1, const int node2);
+        const int add_merge(const int node1, const int node2);
+        /*
+         * set result to the mesh of node.  Only the nodes whose mesh is not
+         * already kept are calculated.
+         *
+         * exception safety: basic guarantee - out_of_range if node is not a 
+         *                   node index.  result is only changed if the 
+         *                   evaluation succeeds.  The meshes of nodes that 
+         *                   were calculated before an exception are kept.
+         */
+        void evaluate(const int node, Mesh_3D& result);
+        // remove all nodes.  The meshes are kept.
+        // exception safety: no throw
+        void clear();
+        // remove all kept meshes.  The nodes are not changed.
+        // exception safety: no throw
+        void clear_meshes();
+        // remove the kept meshes that are not the mesh of a current node
+        // exception safety: strong guarantee
+        void remove_unused_meshes();
+        // number of kept meshes
+        // exception safety: no throw
+        size_type mesh_count() const { return meshes.size(); }
+    private:
+        enum Node_Type { mesh_node, cuboid_node, cylinder_node, e_cylinder_node, sphere_node, 
+                ellipsoid_node, transform_node, difference_node, intersection_node, merge_node };
+
+        /*
+         * What a node calculates.  Nodes with equal content have the same 
+         * mesh.  values are the node values (for a mesh node the precision,
+         * weld flag and point coordinates) and ids are the content ids of the
+         * nodes used (for a mesh node the facet point indices).  Zeros are 
+         * stored as 0.0 so -0.0 and 0.0 are the same content.
+         */
+        struct Content {
+            Node_Type type;
+            vector<Measurement> values;
+            vector<int> ids;
+            Content(const Node_Type t);
+            void add_value(const Measurement value) { values.push_back(value == 0 ? 0.0 : value); }
+            void add_point(const Point_3D& pt);
+            const bool operator==(const Content& content) const;
+        };
+
+        // Content hasher
+        struct Content_Hasher {
+            const size_t operator()(const Content& content) const;
+        };
+
+        /*
+         * Calculates the mesh of each content id in ids from the meshes of
+         * the contents it uses.  Used with run_queries.
+         */
+        class Evaluator {
+        public:
+            Evaluator(const CSG_Tree_3D& t, const vector<int>& i, const unsigned int threads);
+            const Mesh_3D operator()(const size_t index) const;
+        private:
+            const CSG_Tree_3D& tree;
+            const vector<int>& ids;
+            const unsigned int intersect_threads; // threads for each difference, intersection or merge
+        };
+
+        Measurement precision;
+        unsigned int num_threads;
+        vector<int> nodes; // content id of each node
+        unordered_map<Content, int, Content_Hasher> content_ids;
+        vector<const Content*> contents; // by content id, null if removed
+        unordered_map<int, Mesh_3D> meshes; // by content id
+
+        // add a node with the content, sharing the content id with equal content
+        const int add_node(const Content& content);
+        // content id of node
+        const int node_content(const int node) const;
+        /*
+         * add to levels the content ids used by id whose mesh is not kept.
+         * levels[i] has the ids that only use kept meshes and ids in lower
+         * levels.  Returns the level of id or -1 if its mesh is kept.
+         */
+        const int add_to_levels(const int id, vector<vector<int>>& levels, 
+                unordered_map<int, int>& id_levels) const;
+    };
+}
+
+#endif /* CSG_TREE_3D_H */
@@ -18,6 +18,9 @@
  */
 
 #include "Facet_3D.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace VCAD_lib
 {
@@ -73,9 +76,7 @@ namespace VCAD_lib
 
     const Vector_3D Facet_3D::get_unv() const
     {
-        Vector_3D unv(cross_product(Vector_3D(*p1, *p2), Vector_3D(*p1, *p3)));
-        unv.normalize();
-        return unv;
+        return facet_unv(*p1, *p2, *p3);
     }
     
     void Facet_3D::invert_unv()
@@ -86,33 +87,46 @@ namespace VCAD_lib
     
     const Point_3D Facet_3D::get_inside_point() const
     {
-        Vector_3D v1(*p1,*p2);
-        Vector_3D v2(*p2,*p3);
-        return *p1 + v1 * 0.5 + v2 * 0.25;
+        return facet_inside_point(*p1, *p2, *p3);
     }
 
     const bool Facet_3D::contains_point(const Point_3D& pt, bool& pt_is_on_side, Measurement precision) const
     {
-        // make sure point is on facet plane
-        if (!is_pt_on_facet_plane(pt, *this, precision))
-        {
-//            cout << "contains_point: point is not on facet plane returning false\n";
-            return false;
-        }
-        
+        return facet_contains_point(*p1, *p2, *p3, pt, pt_is_on_side, precision);
+    }
+    
+    const Vector_3D facet_unv(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3)
+    {
+        Vector_3D unv(cross_product(Vector_3D(p1, p2), Vector_3D(p1, p3)));
+        unv.normalize();
+        return unv;
+    }
+    
+    const Point_3D facet_inside_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3)
+    {
+        Vector_3D v1(p1,p2);
+        Vector_3D v2(p2,p3);
+        return p1 + v1 * 0.5 + v2 * 0.25;
+    }
+    
+    // determine if a point already known to be on the facet plane is inside the facet
+    static const bool facet_contains_plane_point(const Point_3D& p1, const Point_3D& p2, 
+            const Point_3D& p3, const Point_3D& pt, bool& pt_is_on_side, 
+            const Facet_3D::Measurement precision)
+    {
         // if the point is on p1-p2 or p1-p3, then it is contained in the facet
-        if (is_pt_on_vector(pt, *p1, *p2, precision) || 
-                is_pt_on_vector(pt, *p1, *p3, precision) || 
-                is_pt_on_vector(pt, *p2, *p3, precision))
+        if (is_pt_on_vector(pt, p1, p2, precision) || 
+                is_pt_on_vector(pt, p1, p3, precision) || 
+                is_pt_on_vector(pt, p2, p3, precision))
         {
 //            cout << "contains_point: point is on a vector returning true\n";
             pt_is_on_side = true;
             return true;
         }
 
-        Vector_3D cp_v1v2(cross_product(Vector_3D(*p1, *p2), Vector_3D(*p1, *p3)));
-        Vector_3D cp_v1vp(cross_product(Vector_3D(*p1, *p2), Vector_3D(*p1, pt)));
-        Vector_3D cp_vpv2(cross_product(Vector_3D(*p1, pt), Vector_3D(*p1, *p3)));
+        Vector_3D cp_v1v2(cross_product(Vector_3D(p1, p2), Vector_3D(p1, p3)));
+        Vector_3D cp_v1vp(cross_product(Vector_3D(p1, p2), Vector_3D(p1, pt)));
+        Vector_3D cp_vpv2(cross_product(Vector_3D(p1, pt), Vector_3D(p1, p3)));
 
 //        cout << "contains_point: cp_v1v2 x: " << cp_v1v2.get_x() << " y: " << cp_v1v2.get_y() << " z: " << cp_v1v2.get_z() << "\n";
 //        cout << "contains_point: cp_v1vp x: " << cp_v1vp.get_x() << " y: " << cp_v1vp.get_y() << " z: " << cp_v1vp.get_z() << "\n";
@@ -123,9 +137,9 @@ namespace VCAD_lib
         if (dot_product(cp_v1v2, cp_v1vp) > 0 && dot_product(cp_v1v2, cp_vpv2) > 0)
         {
         
-            cp_v1v2 = cross_product(Vector_3D(*p2, *p3), Vector_3D(*p2, *p1));
-            cp_v1vp = cross_product(Vector_3D(*p2, *p3), Vector_3D(*p2, pt));
-            cp_vpv2 = cross_product(Vector_3D(*p2, pt), Vector_3D(*p2, *p1));
+            cp_v1v2 = cross_product(Vector_3D(p2, p3), Vector_3D(p2, p1));
+            cp_v1vp = cross_product(Vector_3D(p2, p3), Vector_3D(p2, pt));
+            cp_vpv2 = cross_product(Vector_3D(p2, pt), Vector_3D(p2, p1));
 
     //        cout << "contains_point: cp_v1v2 x: " << cp_v1v2.get_x() << " y: " << cp_v1v2.get_y() << " z: " << cp_v1v2.get_z() << "\n";
     //        cout << "contains_point: cp_v1vp x: " << cp_v1vp.get_x() << " y: " << cp_v1vp.get_y() << " z: " << cp_v1vp.get_z() << "\n";
@@ -136,9 +150,9 @@ namespace VCAD_lib
             if (dot_product(cp_v1v2, cp_v1vp) > 0 && dot_product(cp_v1v2, cp_vpv2) > 0)
             {
 
-                cp_v1v2 = cross_product(Vector_3D(*p3, *p1), Vector_3D(*p3, *p2));
-                cp_v1vp = cross_product(Vector_3D(*p3, *p1), Vector_3D(*p3, pt));
-                cp_vpv2 = cross_product(Vector_3D(*p3, pt), Vector_3D(*p3, *p2));
+                cp_v1v2 = cross_product(Vector_3D(p3, p1), Vector_3D(p3, p2));
+                cp_v1vp = cross_product(Vector_3D(p3, p1), Vector_3D(p3, pt));
+                cp_vpv2 = cross_product(Vector_3D(p3, pt), Vector_3D(p3, p2));
 
         //        cout << "contains_point: cp_v1v2 x: " << cp_v1v2.get_x() << " y: " << cp_v1v2.get_y() << " z: " << cp_v1v2.get_z() << "\n";
         //        cout << "contains_point: cp_v1vp x: " << cp_v1vp.get_x() << " y: " << cp_v1vp.get_y() << " z: " << cp_v1vp.get_z() << "\n";
@@ -161,6 +175,128 @@ namespace VCAD_lib
         return false;
     }
     
+    /*
+     * Unit normals of the facet sides in the facet plane pointing into the 
+     * facet and their dot product with the side start point.  Returns false
+     * if a side has no length or the points do not form a triangle.
+     */
+    static const bool facet_side_planes(const Point_3D& p1, const Point_3D& p2, 
+            const Point_3D& p3, Facet_3D::Measurement normals[3][3], 
+            Facet_3D::Measurement offsets[3])
+    {
+        // use the normal from the points so the side normals point in even 
+        // if a supplied unit normal vector is reversed
+        const Vector_3D n(cross_product(Vector_3D(p1, p2), Vector_3D(p1, p3)));
+        const Point_3D* pts[3] = { &p1, &p2, &p3 };
+        for (int side = 0; side < 3; ++side)
+        {
+            const Point_3D& start(*pts[side]);
+            const Vector_3D normal(cross_product(n, Vector_3D(start, *pts[(side + 1) % 3])));
+            const Facet_3D::Measurement length(normal.length());
+            if (length == 0)
+                return false;
+            normals[side][0] = normal.get_x() / length;
+            normals[side][1] = normal.get_y() / length;
+            normals[side][2] = normal.get_z() / length;
+            offsets[side] = normals[side][0] * start.get_x() + normals[side][1] * start.get_y() + 
+                    normals[side][2] * start.get_z();
+        }
+        return true;
+    }
+    
+    /*
+     * Distance from a facet side beyond which is_pt_on_vector cannot find the
+     * point on the side.  is_equal allows precision times the largest 
+     * coordinate on each axis.  The epsilon part covers the rounding errors
+     * of the side distances.
+     */
+    static const Facet_3D::Measurement facet_side_margin(const Facet_3D::Measurement largest, 
+            const Facet_3D::Measurement precision)
+    {
+        return (4 * precision + 64 * numeric_limits<Facet_3D::Measurement>::epsilon()) * largest;
+    }
+    
+    /*
+     * Check a point on the facet plane against the facet side planes.  Returns
+     * 1 if the point is inside every side by more than margin, -1 if it is 
+     * outside a side by more than margin and 0 if it is too close to a side
+     * to tell without the full side tests.
+     */
+    static const int facet_side_check(const Facet_3D::Measurement normals[3][3], 
+            const Facet_3D::Measurement offsets[3], const Point_3D& pt, 
+            const Facet_3D::Measurement margin)
+    {
+        int result(1);
+        for (int side = 0; side < 3; ++side)
+        {
+            const Facet_3D::Measurement distance(normals[side][0] * pt.get_x() + 
+                    normals[side][1] * pt.get_y() + normals[side][2] * pt.get_z() - offsets[side]);
+            if (distance < -margin)
+                return -1;
+            if (distance <= margin)
+                result = 0;
+        }
+        return result;
+    }
+    
+    // largest coordinate size of pt and largest
+    static const Facet_3D::Measurement largest_coordinate(const Point_3D& pt, 
+            const Facet_3D::Measurement largest)
+    {
+        return max(largest, max(fabs(pt.get_x()), max(fabs(pt.get_y()), fabs(pt.get_z()))));
+    }
+    
+    /*
+     * Same result as facet_contains_plane_point.  Points clearly inside or 
+     * outside the facet are decided by the side planes.
+     */
+    static const bool quick_contains_plane_point(const Point_3D& p1, const Point_3D& p2, 
+            const Point_3D& p3, const Point_3D& pt, bool& pt_is_on_side, 
+            const Facet_3D::Measurement precision)
+    {
+        Facet_3D::Measurement normals[3][3];
+        Facet_3D::Measurement offsets[3];
+        if (facet_side_planes(p1, p2, p3, normals, offsets))
+        {
+            const Facet_3D::Measurement largest(largest_coordinate(pt, largest_coordinate(p1, 
+                    largest_coordinate(p2, largest_coordinate(p3, 1)))));
+            const int side_check(facet_side_check(normals, offsets, pt, 
+                    facet_side_margin(largest, precision)));
+            if (side_check == 1)
+            {
+                pt_is_on_side = false;
+                return true;
+            }
+            if (side_check == -1)
+                return false;
+        }
+        return facet_contains_plane_point(p1, p2, p3, pt, pt_is_on_side, precision);
+    }
+    
+    const bool facet_contains_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+            const Point_3D& pt, bool& pt_is_on_side, const Facet_3D::Measurement precision)
+    {
+        // make sure point is on facet plane
+        if (!is_equal(pt, p1, precision) && !is_pt_on_facet_plane(pt, p1, facet_unv(p1, p2, p3), precision))
+        {
+//            cout << "contains_point: point is not on facet plane returning false\n";
+            return false;
+        }
+        
+        return quick_contains_plane_point(p1, p2, p3, pt, pt_is_on_side, precision);
+    }
+    
+    const bool facet_contains_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+            const Vector_3D& unv, const Point_3D& pt, bool& pt_is_on_side, 
+            const Facet_3D::Measurement precision)
+    {
+        // make sure point is on facet plane
+        if (!is_equal(pt, p1, precision) && !is_pt_on_facet_plane(pt, p1, unv, precision))
+            return false;
+        
+        return quick_contains_plane_point(p1, p2, p3, pt, pt_is_on_side, precision);
+    }
+    
     const bool is_equal(const Facet_3D& f1, const Facet_3D& f2, const Facet_3D::Measurement precision)
     {
         return (is_equal(*f1.get_point1(), *f2.get_point1(), precision) && is_equal(*f1.get_point2(), *f2.get_point2(), precision) && is_equal(*f1.get_point3(), *f2.get_point3(), precision)) || 
@@ -174,18 +310,23 @@ namespace VCAD_lib
         if (is_equal(point, *facet.get_point1(), precision))
             return true;
         
+        return is_pt_on_facet_plane(point, *facet.get_point1(), facet.get_unv(), precision);
+    }
+    
+    const bool is_pt_on_facet_plane(const Point_3D& point, const Point_3D& facet_pt, 
+            const Vector_3D& unv, const Facet_3D::Measurement precision)
+    {
         // The equation of the plane P through (x0, y0, z0) that has a normal vector 
         // n=Ai + Bj + ck is:
         //    A(x - x0) + B(y - y0) + C(z - z0) = 0
-        Vector_3D unv(facet.get_unv());
-        Facet_3D::Measurement result(unv.get_x() * (point.get_x() - facet.get_point1()->get_x()));
+        Facet_3D::Measurement result(unv.get_x() * (point.get_x() - facet_pt.get_x()));
         Facet_3D::Measurement largest(fabs(result));
-        Facet_3D::Measurement next(unv.get_y() * (point.get_y() - facet.get_point1()->get_y()));
+        Facet_3D::Measurement next(unv.get_y() * (point.get_y() - facet_pt.get_y()));
         result += next;
         Facet_3D::Measurement error_bound(fabs(next));
         if (error_bound > largest)
             largest = error_bound;
-        next = unv.get_z() * (point.get_z() - facet.get_point1()->get_z());
+        next = unv.get_z() * (point.get_z() - facet_pt.get_z());
         result += next;
         error_bound = fabs(next);
         if (error_bound > largest)
@@ -199,7 +340,15 @@ namespace VCAD_lib
     const bool intersect_line_facet_plane(const Vector_3D& v, const Point_3D& o, 
             const Facet_3D& facet, Point_3D& i_point, const Facet_3D::Measurement precision)
     {
-        // facet - the facet to check if the line intersects
+        return intersect_line_facet_plane(v, o, *facet.get_point1(), *facet.get_point2(), 
+                *facet.get_point3(), facet.get_unv(), i_point, precision);
+    }
+    
+    const bool intersect_line_facet_plane(const Vector_3D& v, const Point_3D& o, 
+            const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, const Vector_3D& unv, 
+            Point_3D& i_point, const Facet_3D::Measurement precision)
+    {
+        // facet - the facet (p1, p2, p3 with unit normal vector unv) to check if the line intersects
         // v - the vector forming the line
         // o - the vector's origin
         //
@@ -237,8 +386,7 @@ namespace VCAD_lib
         // t = (A*x0 - A*p1X + B*y0 - B*p1Y + C*z0 - C*p1Z) / (A*vX + B*vY + C*vZ)
         //
         // possible points to use in plane equation
-        // unit normal vector to use in plane equation
-        Vector_3D unv = facet.get_unv();
+        // unit normal vector to use in plane equation is unv
         // the following two points are used for the line equations
         Facet_3D::Measurement bottom(unv.get_x() * v.get_x());
         Facet_3D::Measurement largest(fabs(bottom));
@@ -258,13 +406,13 @@ namespace VCAD_lib
         {
 //            cout << "ilfp: calculating from facet p1\n";
             // t = (A*x0 - A*p1X + B*y0 - B*p1Y + C*z0 - C*p1Z) / (A*vX + B*vY + C*vZ)
-            Facet_3D::Measurement t(unv.get_x() * (facet.get_point1()->get_x() - o.get_x()) + unv.get_y() * (facet.get_point1()->get_y() - o.get_y()) + unv.get_z() * (facet.get_point1()->get_z() - o.get_z()));
+            Facet_3D::Measurement t(unv.get_x() * (p1.get_x() - o.get_x()) + unv.get_y() * (p1.get_y() - o.get_y()) + unv.get_z() * (p1.get_z() - o.get_z()));
             t /= bottom;
             // check if point does lie on the plane
             Point_3D p = o + v * t;
 
 //            cout << "ilfp i_point x: " << p.get_x() << " y: " << p.get_y() << " z: " << p.get_z() << "\n";
-            if (is_pt_on_facet_plane(p, facet, precision))
+            if (is_equal(p, p1, precision) || is_pt_on_facet_plane(p, p1, unv, precision))
             {
                 i_point = p;
                 return true;
@@ -272,13 +420,13 @@ namespace VCAD_lib
             
 //            cout << "ilfp: calculating from facet p2\n";
             // t = (A*x0 - A*p1X + B*y0 - B*p1Y + C*z0 - C*p1Z) / (A*vX + B*vY + C*vZ)
-            t = unv.get_x() * (facet.get_point2()->get_x() - o.get_x()) + unv.get_y() * (facet.get_point2()->get_y() - o.get_y()) + unv.get_z() * (facet.get_point2()->get_z() - o.get_z());
+            t = unv.get_x() * (p2.get_x() - o.get_x()) + unv.get_y() * (p2.get_y() - o.get_y()) + unv.get_z() * (p2.get_z() - o.get_z());
             t /= bottom;
             // check if point does lie on the plane
             p = o + v * t;
 
 //            cout << "ilfp i_point x: " << p.get_x() << " y: " << p.get_y() << " z: " << p.get_z() << "\n";
-            if (is_pt_on_facet_plane(p, facet, precision))
+            if (is_equal(p, p1, precision) || is_pt_on_facet_plane(p, p1, unv, precision))
             {
                 i_point = p;
                 return true;
@@ -286,19 +434,19 @@ namespace VCAD_lib
             
 //            cout << "ilfp: calculating from facet p3\n";
             // t = (A*x0 - A*p1X + B*y0 - B*p1Y + C*z0 - C*p1Z) / (A*vX + B*vY + C*vZ)
-            t = unv.get_x() * (facet.get_point3()->get_x() - o.get_x()) + unv.get_y() * (facet.get_point3()->get_y() - o.get_y()) + unv.get_z() * (facet.get_point3()->get_z() - o.get_z());
+            t = unv.get_x() * (p3.get_x() - o.get_x()) + unv.get_y() * (p3.get_y() - o.get_y()) + unv.get_z() * (p3.get_z() - o.get_z());
             t /= bottom;
             // check if point does lie on the plane
             p = o + v * t;
 
 //            cout << "ilfp i_point x: " << p.get_x() << " y: " << p.get_y() << " z: " << p.get_z() << "\n";
-            if (is_pt_on_facet_plane(p, facet, precision))
+            if (is_equal(p, p1, precision) || is_pt_on_facet_plane(p, p1, unv, precision))
             {
                 i_point = p;
                 return true;
             }
         }
-        else if (is_pt_on_facet_plane(o, facet, precision)) // vector is parallel, so see if origin is on facet plane
+        else if (is_equal(o, p1, precision) || is_pt_on_facet_plane(o, p1, unv, precision)) // vector is parallel, so see if origin is on facet plane
         {
             i_point = o;
             return true;
@@ -306,4 +454,117 @@ namespace VCAD_lib
         
         return false;
     }
+    
+    const Point_3D facet_closest_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+            const Point_3D& pt)
+    {
+        // find which region of the facet plane pt projects to: a corner, a 
+        // side or the inside of the facet (Ericson, Real-Time Collision 
+        // Detection 5.1.5)
+        const Vector_3D v12(p1, p2);
+        const Vector_3D v13(p1, p3);
+        const Vector_3D v1p(p1, pt);
+        const Facet_3D::Measurement d1(dot_product(v12, v1p));
+        const Facet_3D::Measurement d2(dot_product(v13, v1p));
+        if (d1 <= 0 && d2 <= 0)
+            return p1;
+        
+        const Vector_3D v2p(p2, pt);
+        const Facet_3D::Measurement d3(dot_product(v12, v2p));
+        const Facet_3D::Measurement d4(dot_product(v13, v2p));
+        if (d3 >= 0 && d4 <= d3)
+            return p2;
+        
+        const Facet_3D::Measurement vc(d1 * d4 - d3 * d2);
+        if (vc <= 0 && d1 >= 0 && d3 <= 0 && d1 - d3 > 0)
+            return p1 + v12 * (d1 / (d1 - d3)); // on side p1 p2
+        
+        const Vector_3D v3p(p3, pt);
+        const Facet_3D::Measurement d5(dot_product(v12, v3p));
+        const Facet_3D::Measurement d6(dot_product(v13, v3p));
+        if (d6 >= 0 && d5 <= d6)
+            return p3;
+        
+        const Facet_3D::Measurement vb(d5 * d2 - d1 * d6);
+        if (vb <= 0 && d2 >= 0 && d6 <= 0 && d2 - d6 > 0)
+            return p1 + v13 * (d2 / (d2 - d6)); // on side p1 p3
+        
+        const Facet_3D::Measurement va(d3 * d6 - d5 * d4);
+        if (va <= 0 && d4 - d3 >= 0 && d5 - d6 >= 0 && (d4 - d3) + (d5 - d6) > 0)
+            return p2 + Vector_3D(p2, p3) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))); // on side p2 p3
+        
+        const Facet_3D::Measurement total(va + vb + vc);
+        if (total == 0) // points do not form a triangle
+            return p1;
+        return p1 + v12 * (vb / total) + v13 * (vc / total);
+    }
+    
+    Fast_Facet_3D::Fast_Facet_3D(const Point_3D& pt1, const Point_3D& pt2, const Point_3D& pt3) : 
+            p1(pt1), p2(pt2), p3(pt3), unv(0, 0, 0), offset(0), valid(false), sides_valid(false), 
+            largest(1)
+    {
+        const Point_3D* pts[3] = { &p1, &p2, &p3 };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            box_min[axis] = numeric_limits<Measurement>::infinity();
+            box_max[axis] = -numeric_limits<Measurement>::infinity();
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            const Measurement coords[3] = { pts[i]->get_x(), pts[i]->get_y(), pts[i]->get_z() };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                box_min[axis] = min(box_min[axis], coords[axis]);
+                box_max[axis] = max(box_max[axis], coords[axis]);
+            }
+            largest = largest_coordinate(*pts[i], largest);
+        }
+        
+        if (cross_product(Vector_3D(p1, p2), Vector_3D(p1, p3)).length() == 0) // not a triangle
+            return;
+        unv = facet_unv(p1, p2, p3);
+        offset = unv.get_x() * p1.get_x() + unv.get_y() * p1.get_y() + unv.get_z() * p1.get_z();
+        valid = true;
+        sides_valid = facet_side_planes(p1, p2, p3, side_normals, side_offsets);
+    }
+    
+    const bool Fast_Facet_3D::contains_point(const Point_3D& pt, bool& pt_is_on_side, 
+            const Measurement precision) const
+    {
+        if (!valid)
+            return false;
+        
+        const Measurement margin(facet_side_margin(largest_coordinate(pt, largest), precision));
+        // a point outside the box by more than margin cannot be on the facet
+        // plane within the facet
+        if (pt.get_x() < box_min[0] - margin || pt.get_x() > box_max[0] + margin || 
+                pt.get_y() < box_min[1] - margin || pt.get_y() > box_max[1] + margin || 
+                pt.get_z() < box_min[2] - margin || pt.get_z() > box_max[2] + margin)
+            return false;
+        
+        // make sure point is on facet plane
+        if (!is_equal(pt, p1, precision) && !is_pt_on_facet_plane(pt, p1, unv, precision))
+            return false;
+        
+        if (sides_valid)
+        {
+            const int side_check(facet_side_check(side_normals, side_offsets, pt, margin));
+            if (side_check == 1)
+            {
+                pt_is_on_side = false;
+                return true;
+            }
+            if (side_check == -1)
+                return false;
+        }
+        return facet_contains_plane_point(p1, p2, p3, pt, pt_is_on_side, precision);
+    }
+    
+    const bool Fast_Facet_3D::intersect_line(const Vector_3D& v, const Point_3D& o, Point_3D& i_point, 
+            const Measurement precision) const
+    {
+        if (!valid)
+            return false;
+        return intersect_line_facet_plane(v, o, p1, p2, p3, unv, i_point, precision);
+    }
 }
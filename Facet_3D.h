@@ -80,12 +80,101 @@ namespace VCAD_lib
     const bool is_pt_on_facet_plane(const Point_3D& point, const Facet_3D& facet, 
             const Facet_3D::Measurement precision);
     
+    /*
+     * determine if the specified point is on the plane through facet_pt with 
+     * unit normal vector unv.  Unlike the Facet_3D version, does not first 
+     * check if point is equal to facet_pt.
+     * exception safety: no throw
+     */
+    const bool is_pt_on_facet_plane(const Point_3D& point, const Point_3D& facet_pt, 
+            const Vector_3D& unv, const Facet_3D::Measurement precision);
+    
     // line is defined by the vector and point.  Facet plane is defined by f.
     // returns true if an intersect point was found.  Intersect point is stored
     // in the i_point argument
     // exception safety: no throw
     const bool intersect_line_facet_plane(const Vector_3D& v, const Point_3D& o, 
             const Facet_3D& f, Point_3D& i_point, const Facet_3D::Measurement precision);
+    
+    /*
+     * Facet_3D calculations done directly on the three facet points (in 
+     * counter-clockwise order).  These allow a mesh facet to be tested without 
+     * creating a Facet_3D.
+     */
+    // exception safety: strong guarantee throws length_error if calculated vector has zero length
+    const Vector_3D facet_unv(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3);
+    // exception safety: no throw
+    const Point_3D facet_inside_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3);
+    const bool facet_contains_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+            const Point_3D& pt, bool& pt_is_on_side, const Facet_3D::Measurement precision);
+    // same as above using an already calculated facet unit normal vector
+    // exception safety: no throw
+    const bool facet_contains_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+            const Vector_3D& unv, const Point_3D& pt, bool& pt_is_on_side, 
+            const Facet_3D::Measurement precision);
+    // unv is the facet unit normal vector
+    // exception safety: no throw
+    const bool intersect_line_facet_plane(const Vector_3D& v, const Point_3D& o, 
+            const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, const Vector_3D& unv, 
+            Point_3D& i_point, const Facet_3D::Measurement precision);
+    // the point on the facet (including its sides) closest to pt
+    // exception safety: no throw
+    const Point_3D facet_closest_point(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+            const Point_3D& pt);
+
+    /*
+     * A copy of three facet points (in counter-clockwise order) with the data
+     * the facet tests need already calculated: the unit normal vector, the
+     * plane offset, the box around the points and the in plane normals of the
+     * sides.  Used when the same facet is tested against many points.
+     *
+     * contains_point gives the same result as facet_contains_point.  Points
+     * that are clearly inside or outside the facet are decided by their
+     * distance from the sides.  Only points close to a side use the full
+     * side tests.
+     */
+    class Fast_Facet_3D {
+    public:
+        typedef Point_3D::Measurement Measurement;
+        // exception safety: strong guarantee
+        Fast_Facet_3D(const Point_3D& pt1, const Point_3D& pt2, const Point_3D& pt3);
+        // false if the points do not form a triangle
+        // exception safety: no throw
+        const bool is_valid() const { return valid; }
+        // exception safety: no throw
+        const Point_3D& get_point1() const { return p1; }
+        // exception safety: no throw
+        const Point_3D& get_point2() const { return p2; }
+        // exception safety: no throw
+        const Point_3D& get_point3() const { return p3; }
+        // zero length if the facet is not valid
+        // exception safety: no throw
+        const Vector_3D& get_unv() const { return unv; }
+        // dot product of the unit normal vector with a point on the plane
+        // exception safety: no throw
+        const Measurement get_offset() const { return offset; }
+        // always false if the facet is not valid
+        // exception safety: no throw
+        const bool contains_point(const Point_3D& pt, bool& pt_is_on_side,
+                const Measurement precision) const;
+        // same as intersect_line_facet_plane.  Always false if the facet is not valid
+        // exception safety: no throw
+        const bool intersect_line(const Vector_3D& v, const Point_3D& o, Point_3D& i_point,
+                const Measurement precision) const;
+    private:
+        Point_3D p1;
+        Point_3D p2;
+        Point_3D p3;
+        Vector_3D unv;
+        Measurement offset;
+        bool valid;
+        bool sides_valid;               // false if a side has no length
+        Measurement side_normals[3][3]; // unit normal of each side in the plane pointing in
+        Measurement side_offsets[3];    // dot product of each side normal with the side start point
+        Measurement box_min[3];
+        Measurement box_max[3];
+        Measurement largest;            // largest point coordinate size, at least 1
+    };
 }
 
 #endif /* FACET2_3D_H */
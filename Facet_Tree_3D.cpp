@@ -0,0 +1,208 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Facet_Tree_3D.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Facet_Tree_3D.h"
+#include "Mesh_3D.h"
+
+namespace VCAD_lib
+{
+    // a node with this many facets or less is not split
+    static const int max_leaf_facets = 4;
+
+    Facet_Tree_3D::Facet_Tree_3D(const Mesh_3D& mesh) : nodes(), facet_order()
+    {
+        if (mesh.empty())
+            return;
+
+        // box (min x,y,z, max x,y,z) and center of every facet
+        const Measurement precision(mesh.get_precision());
+        const int num_facets(mesh.size());
+        vector<Measurement> bounds;
+        bounds.reserve(6 * num_facets);
+        vector<Measurement> centers;
+        centers.reserve(3 * num_facets);
+        Mesh_3D::const_point_iterator pts(mesh.point_begin());
+        for (Mesh_3D::const_facet_iterator it = mesh.facet_begin(); it != mesh.facet_end(); ++it)
+        {
+            const Point_3D& p1(*pts[it->get_p1_index()]);
+            const Point_3D& p2(*pts[it->get_p2_index()]);
+            const Point_3D& p3(*pts[it->get_p3_index()]);
+            const Measurement x[3] = { p1.get_x(), p2.get_x(), p3.get_x() };
+            const Measurement y[3] = { p1.get_y(), p2.get_y(), p3.get_y() };
+            const Measurement z[3] = { p1.get_z(), p2.get_z(), p3.get_z() };
+            bounds.push_back(min(x[0], min(x[1], x[2])) - precision);
+            bounds.push_back(min(y[0], min(y[1], y[2])) - precision);
+            bounds.push_back(min(z[0], min(z[1], z[2])) - precision);
+            bounds.push_back(max(x[0], max(x[1], x[2])) + precision);
+            bounds.push_back(max(y[0], max(y[1], y[2])) + precision);
+            bounds.push_back(max(z[0], max(z[1], z[2])) + precision);
+            centers.push_back((x[0] + x[1] + x[2]) / 3);
+            centers.push_back((y[0] + y[1] + y[2]) / 3);
+            centers.push_back((z[0] + z[1] + z[2]) / 3);
+        }
+
+        facet_order.reserve(num_facets);
+        for (int i = 0; i < num_facets; ++i)
+            facet_order.push_back(i);
+        nodes.reserve(2 * (num_facets / max_leaf_facets) + 1);
+        build(0, num_facets, bounds, centers);
+    }
+
+    Facet_Tree_3D::Facet_Tree_3D(const vector<Measurement>& bounds) : nodes(), facet_order()
+    {
+        const int num_boxes(bounds.size() / 6);
+        if (num_boxes == 0)
+            return;
+
+        vector<Measurement> centers;
+        centers.reserve(3 * num_boxes);
+        for (int i = 0; i < num_boxes; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+                centers.push_back((bounds[6 * i + axis] + bounds[6 * i + 3 + axis]) / 2);
+        }
+
+        facet_order.reserve(num_boxes);
+        for (int i = 0; i < num_boxes; ++i)
+            facet_order.push_back(i);
+        nodes.reserve(2 * (num_boxes / max_leaf_facets) + 1);
+        build(0, num_boxes, bounds, centers);
+    }
+
+    void Facet_Tree_3D::find_overlaps(const Point_3D& min_pt, const Point_3D& max_pt, vector<int>& indices) const
+    {
+        if (nodes.empty())
+            return;
+
+        const Measurement box_min[3] = { min_pt.get_x(), min_pt.get_y(), min_pt.get_z() };
+        const Measurement box_max[3] = { max_pt.get_x(), max_pt.get_y(), max_pt.get_z() };
+        vector<int> stack(1, 0);
+        while (!stack.empty())
+        {
+            const int node_index(stack.back());
+            stack.pop_back();
+            const Node& node(nodes[node_index]);
+            if (box_max[0] < node.min[0] || box_min[0] > node.max[0] || box_max[1] < node.min[1] ||
+                    box_min[1] > node.max[1] || box_max[2] < node.min[2] || box_min[2] > node.max[2])
+                continue;
+            if (node.first == -1)
+            {
+                stack.push_back(node.count);
+                stack.push_back(node_index + 1);
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; ++i)
+                indices.push_back(facet_order[i]);
+        }
+    }
+
+    void Facet_Tree_3D::build(const int first, const int last, const vector<Measurement>& bounds,
+            const vector<Measurement>& centers)
+    {
+        Node node;
+        Measurement center_min[3];
+        Measurement center_max[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            node.min[axis] = numeric_limits<Measurement>::infinity();
+            node.max[axis] = -numeric_limits<Measurement>::infinity();
+            center_min[axis] = numeric_limits<Measurement>::infinity();
+            center_max[axis] = -numeric_limits<Measurement>::infinity();
+        }
+        for (int i = first; i < last; ++i)
+        {
+            const int facet(facet_order[i]);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                node.min[axis] = min(node.min[axis], bounds[6 * facet + axis]);
+                node.max[axis] = max(node.max[axis], bounds[6 * facet + 3 + axis]);
+                center_min[axis] = min(center_min[axis], centers[3 * facet + axis]);
+                center_max[axis] = max(center_max[axis], centers[3 * facet + axis]);
+            }
+        }
+
+        // split along the longest side of the box around the facet centers
+        int split_axis(0);
+        for (int axis = 1; axis < 3; ++axis)
+        {
+            if (center_max[axis] - center_min[axis] > center_max[split_axis] - center_min[split_axis])
+                split_axis = axis;
+        }
+
+        const int node_index(nodes.size());
+        if (last - first <= max_leaf_facets || !(center_max[split_axis] > center_min[split_axis]))
+        {
+            node.first = first;
+            node.count = last - first;
+            nodes.push_back(node);
+            return;
+        }
+
+        node.first = -1;
+        node.count = -1;
+        nodes.push_back(node);
+
+        class Center_Less {
+        public:
+            Center_Less(const vector<Measurement>& c, const int a) : centers(c), axis(a) {}
+            const bool operator()(const int facet1, const int facet2) const
+            {
+                return centers[3 * facet1 + axis] < centers[3 * facet2 + axis];
+            }
+        private:
+            const vector<Measurement>& centers;
+            const int axis;
+        };
+
+        const int middle(first + (last - first) / 2);
+        nth_element(facet_order.begin() + first, facet_order.begin() + middle,
+                facet_order.begin() + last, Center_Less(centers, split_axis));
+        build(first, middle, bounds, centers); // first child follows the node
+        nodes[node_index].count = nodes.size();
+        build(middle, last, bounds, centers);
+    }
+
+    const Facet_Tree_3D::Measurement Facet_Tree_3D::enter_box(const Node& node,
+            const Measurement origin[3], const Measurement inv_dir[3]) const
+    {
+        const Measurement infinity(numeric_limits<Measurement>::infinity());
+        Measurement t_enter(0);
+        Measurement t_exit(infinity);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (inv_dir[axis] == infinity || inv_dir[axis] == -infinity)
+            {
+                // ray is parallel to the sides on this axis
+                if (origin[axis] < node.min[axis] || origin[axis] > node.max[axis])
+                    return infinity;
+                continue;
+            }
+            Measurement t1((node.min[axis] - origin[axis]) * inv_dir[axis]);
+            Measurement t2((node.max[axis] - origin[axis]) * inv_dir[axis]);
+            if (t1 > t2)
+                swap(t1, t2);
+            t_enter = max(t_enter, t1);
+            t_exit = min(t_exit, t2);
+            if (t_enter > t_exit)
+                return infinity;
+        }
+        return t_enter;
+    }
+}
+
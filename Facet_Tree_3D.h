@@ -0,0 +1,294 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Facet_Tree_3D.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef FACET_TREE_3D_H
+#define FACET_TREE_3D_H
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "Point_3D.h"
+#include "Vector_3D.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+    class Mesh_3D;
+
+    /*
+     * Bounding volume hierarchy of the facets of a mesh.  Each node has the
+     * axis aligned box around its facets, enlarged by the mesh precision, and
+     * is split in two at the median facet along its longest side until a
+     * node has only a few facets.  Searches only visit the nodes whose box
+     * the point or ray reaches, so a search is O(log N) for a typical mesh.
+     *
+     * The tree only stores facet indices.  The caller decides which facets
+     * are a match.  The tree does not change when the mesh changes (see
+     * Mesh_3D::get_facet_tree).
+     */
+    class Facet_Tree_3D {
+    private:
+        struct Node {
+            Point_3D::Measurement min[3];
+            Point_3D::Measurement max[3];
+            int first; // first index in facet_order (leaf) or -1
+            int count; // number of facets (leaf) or index of the second child
+        };
+    public:
+        typedef Point_3D::Measurement Measurement;
+        typedef vector<int>::size_type size_type;
+
+        // exception safety: strong guarantee
+        explicit Facet_Tree_3D(const Mesh_3D& mesh);
+        /*
+         * tree of boxes instead of mesh facets.  bounds has six values for
+         * each box: min x, y, z then max x, y, z.  The box index is used in
+         * place of the facet index.  The boxes are not enlarged.
+         * 
+         * exception safety: strong guarantee
+         */
+        explicit Facet_Tree_3D(const vector<Measurement>& bounds);
+        // number of facets in the tree
+        // exception safety: no throw
+        size_type size() const { return facet_order.size(); }
+        // exception safety: no throw
+        bool empty() const { return facet_order.empty(); }
+        /*
+         * Return the first facet index whose box contains pt for which
+         * pred(index) returns true, or -1 if there is no such index.
+         */
+        template <class Predicate>
+        const int find_if(const Point_3D& pt, Predicate pred) const;
+        /*
+         * Find the closest facet along the ray origin + t * direction, t > 0.
+         * intersect(index) is called for the facets whose box the ray reaches
+         * before the closest hit found so far and returns the t of the hit or
+         * infinity if the ray misses the facet.  Returns the closest t found
+         * or infinity if there was no hit.  intersect can keep track of which
+         * facet was hit.
+         */
+        template <class Intersector>
+        const Measurement closest_hit(const Point_3D& origin, const Vector_3D& direction,
+                Intersector& intersect) const;
+        /*
+         * Find the facet closest to pt.  distance(index, limit) is called for
+         * the facets whose box is closer to pt than the closest facet found 
+         * so far, nearest boxes first, and returns the squared distance from
+         * pt to the facet or infinity if it is not wanted.  limit is the 
+         * squared distance of the closest facet found so far.  Returns the 
+         * smallest squared distance found or infinity if there was none.  
+         * distance can keep track of which facet is the closest.
+         */
+        template <class Distance>
+        const Measurement closest_facet(const Point_3D& pt, Distance& distance) const;
+        /*
+         * Add the index of every facet whose box overlaps the box from
+         * min_pt to max_pt to indices.  The indices are not sorted.
+         */
+        void find_overlaps(const Point_3D& min_pt, const Point_3D& max_pt, vector<int>& indices) const;
+        /*
+         * node queries for callers that keep their own data for each node.  
+         * Node 0 is the root, a node is always before its children and the 
+         * first child of a node follows it.  node must be less than 
+         * node_size().
+         */
+        // exception safety: no throw
+        size_type node_size() const { return nodes.size(); }
+        // exception safety: no throw
+        bool is_leaf(const int node) const { return nodes[node].first != -1; }
+        // exception safety: no throw
+        int first_child(const int node) const { return node + 1; }
+        // exception safety: no throw
+        int second_child(const int node) const { return nodes[node].count; }
+        // the facet indices of a leaf node
+        // exception safety: no throw
+        vector<int>::const_iterator leaf_begin(const int node) const { return facet_order.begin() + nodes[node].first; }
+        // exception safety: no throw
+        vector<int>::const_iterator leaf_end(const int node) const 
+        { 
+            return facet_order.begin() + nodes[node].first + nodes[node].count; 
+        }
+        // exception safety: no throw
+        const Point_3D node_min(const int node) const
+        {
+            return Point_3D(nodes[node].min[0], nodes[node].min[1], nodes[node].min[2]);
+        }
+        // exception safety: no throw
+        const Point_3D node_max(const int node) const
+        {
+            return Point_3D(nodes[node].max[0], nodes[node].max[1], nodes[node].max[2]);
+        }
+    private:
+        vector<Node> nodes;
+        vector<int> facet_order; // facet indices in leaf order
+
+        // add the node for facet_order[first, last) and its children
+        void build(const int first, const int last, const vector<Measurement>& bounds,
+                const vector<Measurement>& centers);
+        // squared distance from p to the node box
+        // exception safety: no throw
+        const Measurement box_distance2(const Node& node, const Measurement p[3]) const
+        {
+            Measurement distance2(0);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const Measurement d(max(node.min[axis] - p[axis], max(p[axis] - node.max[axis], 
+                        static_cast<Measurement>(0))));
+                distance2 += d * d;
+            }
+            return distance2;
+        }
+        // t where the ray enters the node box, or infinity if it misses
+        const Measurement enter_box(const Node& node, const Measurement origin[3],
+                const Measurement inv_dir[3]) const;
+    };
+
+    template <class Predicate>
+    const int Facet_Tree_3D::find_if(const Point_3D& pt, Predicate pred) const
+    {
+        if (nodes.empty())
+            return -1;
+
+        const Measurement p[3] = { pt.get_x(), pt.get_y(), pt.get_z() };
+        vector<int> stack(1, 0);
+        while (!stack.empty())
+        {
+            const int node_index(stack.back());
+            stack.pop_back();
+            const Node& node(nodes[node_index]);
+            if (p[0] < node.min[0] || p[0] > node.max[0] || p[1] < node.min[1] ||
+                    p[1] > node.max[1] || p[2] < node.min[2] || p[2] > node.max[2])
+                continue;
+            if (node.first == -1)
+            {
+                stack.push_back(node.count);
+                stack.push_back(node_index + 1);
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; ++i)
+            {
+                if (pred(facet_order[i]))
+                    return facet_order[i];
+            }
+        }
+        return -1;
+    }
+
+    template <class Intersector>
+    const Facet_Tree_3D::Measurement Facet_Tree_3D::closest_hit(const Point_3D& origin,
+            const Vector_3D& direction, Intersector& intersect) const
+    {
+        const Measurement infinity(numeric_limits<Measurement>::infinity());
+        Measurement closest(infinity);
+        if (nodes.empty())
+            return closest;
+
+        const Measurement o[3] = { origin.get_x(), origin.get_y(), origin.get_z() };
+        const Measurement inv_dir[3] = { 1 / direction.get_x(), 1 / direction.get_y(), 1 / direction.get_z() };
+        vector<pair<Measurement,int>> stack;
+        const Measurement root_t(enter_box(nodes[0], o, inv_dir));
+        if (root_t < infinity)
+            stack.push_back(pair<Measurement,int>(root_t, 0));
+        while (!stack.empty())
+        {
+            const pair<Measurement,int> entry(stack.back());
+            stack.pop_back();
+            if (entry.first > closest)
+                continue; // a closer hit was found after the node was added
+            const Node& node(nodes[entry.second]);
+            if (node.first == -1)
+            {
+                // visit the nearer child first
+                const int child1(entry.second + 1);
+                const int child2(node.count);
+                const Measurement t1(enter_box(nodes[child1], o, inv_dir));
+                const Measurement t2(enter_box(nodes[child2], o, inv_dir));
+                if (t1 <= t2)
+                {
+                    if (t2 < closest)
+                        stack.push_back(pair<Measurement,int>(t2, child2));
+                    if (t1 < closest)
+                        stack.push_back(pair<Measurement,int>(t1, child1));
+                }
+                else
+                {
+                    if (t1 < closest)
+                        stack.push_back(pair<Measurement,int>(t1, child1));
+                    if (t2 < closest)
+                        stack.push_back(pair<Measurement,int>(t2, child2));
+                }
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; ++i)
+                closest = min(closest, static_cast<Measurement>(intersect(facet_order[i])));
+        }
+        return closest;
+    }
+
+    template <class Distance>
+    const Facet_Tree_3D::Measurement Facet_Tree_3D::closest_facet(const Point_3D& pt, 
+            Distance& distance) const
+    {
+        Measurement closest(numeric_limits<Measurement>::infinity());
+        if (nodes.empty())
+            return closest;
+
+        const Measurement p[3] = { pt.get_x(), pt.get_y(), pt.get_z() };
+        vector<pair<Measurement,int>> stack(1, pair<Measurement,int>(box_distance2(nodes[0], p), 0));
+        while (!stack.empty())
+        {
+            const pair<Measurement,int> entry(stack.back());
+            stack.pop_back();
+            if (entry.first >= closest)
+                continue; // a closer facet was found after the node was added
+            const Node& node(nodes[entry.second]);
+            if (node.first == -1)
+            {
+                // visit the nearer child first
+                const int child1(entry.second + 1);
+                const int child2(node.count);
+                const Measurement d1(box_distance2(nodes[child1], p));
+                const Measurement d2(box_distance2(nodes[child2], p));
+                if (d1 <= d2)
+                {
+                    if (d2 < closest)
+                        stack.push_back(pair<Measurement,int>(d2, child2));
+                    if (d1 < closest)
+                        stack.push_back(pair<Measurement,int>(d1, child1));
+                }
+                else
+                {
+                    if (d1 < closest)
+                        stack.push_back(pair<Measurement,int>(d1, child1));
+                    if (d2 < closest)
+                        stack.push_back(pair<Measurement,int>(d2, child2));
+                }
+                continue;
+            }
+            for (int i = node.first; i < node.first + node.count; ++i)
+                closest = min(closest, static_cast<Measurement>(distance(facet_order[i], closest)));
+        }
+        return closest;
+    }
+}
+
+#endif /* FACET_TREE_3D_H */
+
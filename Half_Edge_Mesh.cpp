@@ -0,0 +1,119 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Half_Edge_Mesh.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Half_Edge_Mesh.h"
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+#include "Mesh_2D.h"
+#include "Mesh_3D.h"
+
+namespace VCAD_lib
+{
+    // key for the two point indices of a side independent of direction
+    static unsigned long long side_key(const int p1, const int p2)
+    {
+        const unsigned int low(static_cast<unsigned int>(min(p1, p2)));
+        const unsigned int high(static_cast<unsigned int>(max(p1, p2)));
+        return (static_cast<unsigned long long>(low) << 32) | high;
+    }
+
+    Half_Edge_Mesh::Half_Edge_Mesh(const Mesh_3D& mesh) : half_edge_pts(), half_edge_edge(),
+            edge_next(), point_next(), edge_first(), edge_counts(), point_first()
+    {
+        build(mesh.facet_begin(), mesh.facet_end());
+    }
+
+    Half_Edge_Mesh::Half_Edge_Mesh(const Mesh_2D& mesh) : half_edge_pts(), half_edge_edge(),
+            edge_next(), point_next(), edge_first(), edge_counts(), point_first()
+    {
+        build(mesh.facet_begin(), mesh.facet_end());
+    }
+
+    Half_Edge_Mesh::Half_Edge_Mesh(const vector<Facet>& facets) : half_edge_pts(), half_edge_edge(),
+            edge_next(), point_next(), edge_first(), edge_counts(), point_first()
+    {
+        build(facets.begin(), facets.end());
+    }
+
+    Half_Edge_Mesh::Half_Edge_Mesh(const vector<Facet>::const_iterator first,
+            const vector<Facet>::const_iterator last) : half_edge_pts(), half_edge_edge(),
+            edge_next(), point_next(), edge_first(), edge_counts(), point_first()
+    {
+        build(first, last);
+    }
+
+    void Half_Edge_Mesh::build(const vector<Facet>::const_iterator first, const vector<Facet>::const_iterator last)
+    {
+        const size_type num_half_edges(3 * (last - first));
+        half_edge_pts.reserve(num_half_edges);
+        int max_pt(-1);
+        for (vector<Facet>::const_iterator it = first; it != last; ++it)
+        {
+            half_edge_pts.push_back(it->get_p1_index());
+            half_edge_pts.push_back(it->get_p2_index());
+            half_edge_pts.push_back(it->get_p3_index());
+            max_pt = max(max_pt, max(it->get_p1_index(), max(it->get_p2_index(), it->get_p3_index())));
+        }
+
+        // link half edges to their edges and points keeping facet order so
+        // the first half edge of an edge or point is from the first facet
+        half_edge_edge.resize(num_half_edges);
+        edge_next.assign(num_half_edges, -1);
+        point_next.assign(num_half_edges, -1);
+        point_first.assign(max_pt + 1, -1);
+        edge_first.reserve(num_half_edges / 2 + 1);
+        edge_counts.reserve(num_half_edges / 2 + 1);
+        vector<int> edge_last;
+        edge_last.reserve(num_half_edges / 2 + 1);
+        vector<int> point_last(max_pt + 1, -1);
+        unordered_map<unsigned long long,int> edges;
+        edges.reserve(num_half_edges / 2 + 1);
+        for (int h = 0; h < static_cast<int>(num_half_edges); ++h)
+        {
+            const int pt(half_edge_pts[h]);
+            if (pt >= 0)
+            {
+                if (point_last[pt] == -1)
+                    point_first[pt] = h;
+                else
+                    point_next[point_last[pt]] = h;
+                point_last[pt] = h;
+            }
+
+            pair<unordered_map<unsigned long long,int>::iterator,bool> result =
+                    edges.insert(pair<unsigned long long,int>(side_key(pt, point2(h)), edge_first.size()));
+            const int e(result.first->second);
+            half_edge_edge[h] = e;
+            if (result.second)
+            {
+                edge_first.push_back(h);
+                edge_counts.push_back(1);
+                edge_last.push_back(h);
+            }
+            else
+            {
+                edge_next[edge_last[e]] = h;
+                edge_last[e] = h;
+                ++edge_counts[e];
+            }
+        }
+    }
+}
+
@@ -0,0 +1,153 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Half_Edge_Mesh.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef HALF_EDGE_MESH_H
+#define HALF_EDGE_MESH_H
+
+#include <vector>
+#include "Facet.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+    class Mesh_2D;
+    class Mesh_3D;
+
+    /*
+     * Side adjacency of the facets of a mesh.  Only the point indices of the
+     * facets are used, so it works for both Mesh_2D and Mesh_3D.
+     *
+     * Every facet has three half edges.  Half edge h is side h % 3 of facet
+     * h / 3 and goes from point1(h) to point2(h) in the order of the facet
+     * points (p1p2, p2p3, p3p1).  Half edges that join the same two points
+     * belong to the same edge no matter which direction they go.
+     *
+     * All queries are constant time.  A facet side that is not shared has an
+     * edge with one half edge, and a side shared by more than two facets has
+     * an edge with more than two half edges, so boundaries and non manifold
+     * sides can be found by edge_count.
+     *
+     * The object does not change when the mesh changes.  Build a new one
+     * after changing the facets.
+     */
+    class Half_Edge_Mesh {
+    public:
+        typedef vector<int>::size_type size_type;
+        // exception safety: strong guarantee
+        explicit Half_Edge_Mesh(const Mesh_3D& mesh);
+        // exception safety: strong guarantee
+        explicit Half_Edge_Mesh(const Mesh_2D& mesh);
+        // exception safety: strong guarantee
+        explicit Half_Edge_Mesh(const vector<Facet>& facets);
+        // exception safety: strong guarantee
+        Half_Edge_Mesh(const vector<Facet>::const_iterator first, const vector<Facet>::const_iterator last);
+        // exception safety: no throw
+        size_type facet_size() const { return half_edge_pts.size() / 3; }
+        // exception safety: no throw
+        size_type half_edge_size() const { return half_edge_pts.size(); }
+        // exception safety: no throw
+        size_type edge_size() const { return edge_first.size(); }
+        // one more than the largest point index used by a facet
+        // exception safety: no throw
+        size_type point_size() const { return point_first.size(); }
+        /*
+         * half edge queries.  h must be less than half_edge_size().
+         */
+        // the facet containing half edge h
+        // exception safety: no throw
+        int facet(const int h) const { return h / 3; }
+        // the next half edge in the same facet
+        // exception safety: no throw
+        int next(const int h) const { return h % 3 == 2 ? h - 2 : h + 1; }
+        // the previous half edge in the same facet
+        // exception safety: no throw
+        int prev(const int h) const { return h % 3 == 0 ? h + 2 : h - 1; }
+        // the point index the half edge starts at
+        // exception safety: no throw
+        int point1(const int h) const { return half_edge_pts[h]; }
+        // the point index the half edge ends at
+        // exception safety: no throw
+        int point2(const int h) const { return half_edge_pts[next(h)]; }
+        // the edge containing half edge h
+        // exception safety: no throw
+        int edge(const int h) const { return half_edge_edge[h]; }
+        /*
+         * the half edge of the other facet sharing the side, or -1 if the side
+         * is not shared or is shared by more than two facets.  The opposite
+         * half edge goes from point2(h) to point1(h) when the two facets are
+         * wound the same way.
+         */
+        // exception safety: no throw
+        int opposite(const int h) const
+        {
+            const int e(half_edge_edge[h]);
+            if (edge_counts[e] != 2)
+                return -1;
+            return edge_first[e] == h ? edge_next[h] : edge_first[e];
+        }
+        // the next half edge of the same edge, or -1 if h is the last one
+        // exception safety: no throw
+        int next_on_edge(const int h) const { return edge_next[h]; }
+        /*
+         * the next half edge starting at the same point, or -1 if h is the
+         * last one.  Starting at point_half_edge(pt) and following
+         * next_around_point visits every facet using point pt once.
+         */
+        // exception safety: no throw
+        int next_around_point(const int h) const { return point_next[h]; }
+        // true if no other facet shares the side
+        // exception safety: no throw
+        bool is_boundary(const int h) const { return edge_counts[half_edge_edge[h]] == 1; }
+        /*
+         * edge queries.  e must be less than edge_size().
+         */
+        // the first half edge of the edge in facet order
+        // exception safety: no throw
+        int edge_half_edge(const int e) const { return edge_first[e]; }
+        // the number of facets sharing the edge
+        // exception safety: no throw
+        int edge_count(const int e) const { return edge_counts[e]; }
+        /*
+         * point and facet queries
+         */
+        // the first half edge starting at point index pt or -1 if no facet uses it
+        // exception safety: no throw
+        int point_half_edge(const int pt) const
+        {
+            return pt >= 0 && static_cast<size_type>(pt) < point_first.size() ? point_first[pt] : -1;
+        }
+        // the half edge from point 1 to point 2 of facet f
+        // exception safety: no throw
+        int facet_half_edge(const int f) const { return f * 3; }
+    private:
+        vector<int> half_edge_pts;  // start point of each half edge
+        vector<int> half_edge_edge; // edge of each half edge
+        vector<int> edge_next;      // next half edge of the same edge
+        vector<int> point_next;     // next half edge starting at the same point
+        vector<int> edge_first;     // first half edge of each edge
+        vector<int> edge_counts;    // number of half edges of each edge
+        vector<int> point_first;    // first half edge starting at each point
+
+        void build(const vector<Facet>::const_iterator first, const vector<Facet>::const_iterator last);
+    };
+}
+
+#endif /* HALF_EDGE_MESH_H */
+
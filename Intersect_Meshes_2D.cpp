@@ -411,7 +411,7 @@ namespace VCAD_lib
         return ++it;
     }
     
-    const bool Intersect_Meshes_2D::I_Pt_List::validate(const Facet_2D& facet1, 
+    void Intersect_Meshes_2D::I_Pt_List::validate(const Facet_2D& facet1, 
             const Facet_2D& facet2)
     {
 #ifdef DEBUG_INTERSECT_MESHES_2D_I_PT_LIST
@@ -459,19 +459,11 @@ namespace VCAD_lib
     }
     
     Intersect_Meshes_2D::I_Pt_Locator::I_Pt_Locator(const Point_2D::Measurement prec) : precision(prec), 
-            facet1(), facet2(), generated_pts() {}
+            facet1(), facet2(), generated_pts(), generated_grid(prec) {}
 
     Intersect_Meshes_2D::I_Pt_Locator::I_Pt_Data::I_Pt_Data() : num(0), 
             ip1(), ip2() {}
     
-    Intersect_Meshes_2D::I_Pt_Locator::Point_Find::Point_Find(const shared_ptr<Point_2D>& point, 
-            const Point_2D::Measurement prec) : precision(prec), pt(point) {}
-    
-    const bool Intersect_Meshes_2D::I_Pt_Locator::Point_Find::operator()(const shared_ptr<Point_2D>& other_pt)
-    {
-        return is_equal(*pt, *other_pt, precision);
-    }
-    
     const bool Intersect_Meshes_2D::I_Pt_Locator::matches(const shared_ptr<Point_2D>& p1, 
             const shared_ptr<Point_2D>& p2) const
     {
@@ -496,11 +488,23 @@ namespace VCAD_lib
         {
             loc = side_loc;
             // check existing points for pt value
-            vector<shared_ptr<Point_2D>>::const_iterator it = find_if(generated_pts.begin(), generated_pts.end(), Point_Find(i_pt, precision));
-            if (it != generated_pts.end())
-                i_pt = *it;
+            const Point_3D grid_pt(i_pt->get_x(), i_pt->get_y(), 0);
+            const int index(generated_grid.find(grid_pt));
+            if (index != -1)
+                i_pt = generated_pts[index];
             else
+            {
                 generated_pts.push_back(i_pt);
+                try
+                {
+                    generated_grid.insert(grid_pt);
+                }
+                catch (...)
+                {
+                    generated_pts.pop_back();
+                    throw;
+                }
+            }
         }
     }
 
@@ -883,9 +887,10 @@ namespace VCAD_lib
         return true;
     }
     
-    Intersect_Meshes_2D::Facets::Facets() : point_list(), facet_list() {}
+    Intersect_Meshes_2D::Facets::Facets() : point_list(), facet_list(), point_index() {}
     
-    Intersect_Meshes_2D::Facets::Facets(const Mesh_2D& mesh) : point_list(), facet_list() 
+    Intersect_Meshes_2D::Facets::Facets(const Mesh_2D& mesh) : point_list(), facet_list(), 
+            point_index() 
     {
 #ifdef DEBUG_INTERSECT_MESHES_2D_FACETS
         cout << "Intersect_Meshes_2D::Facets begin\n";
@@ -901,34 +906,14 @@ namespace VCAD_lib
             int p1_index(-1);
             int p2_index(-1);
             int p3_index(-1);
-            int index(0);
-            for (vector<shared_ptr<Point_2D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-            {
-                if (matches(*it->get_point1(), **p_it))
-                    p1_index = index;
-                else if (matches(*it->get_point2(), **p_it))
-                    p2_index = index;
-                else if (matches(*it->get_point3(), **p_it))
-                    p3_index = index;
-                ++index;
-            }
+            find_points(*it->get_point1(), *it->get_point2(), *it->get_point3(), 
+                    p1_index, p2_index, p3_index);
             if (p1_index == -1)
-            {
-                point_list.push_back(it->get_point1());
-                p1_index = index;
-                ++index;
-            }
+                p1_index = add_point(it->get_point1());
             if (p2_index == -1)
-            {
-                point_list.push_back(it->get_point2());
-                p2_index = index;
-                ++index;
-            }
+                p2_index = add_point(it->get_point2());
             if (p3_index == -1)
-            {
-                point_list.push_back(it->get_point3());
-                p3_index = index;
-            }
+                p3_index = add_point(it->get_point3());
             facet_list.push_back(Facet(p1_index, p2_index, p3_index));
         }
 #ifdef DEBUG_INTERSECT_MESHES_2D_FACETS
@@ -940,11 +925,7 @@ namespace VCAD_lib
     {
         facet_list.clear();
         point_list.clear();
-    }
-    
-    const bool Intersect_Meshes_2D::Facets::matches(const Point_2D& p1, const Point_2D& p2) const
-    {
-        return p1.get_x() == p2.get_x() && p1.get_y() == p2.get_y();
+        point_index.clear();
     }
     
     const shared_ptr<Point_2D> Intersect_Meshes_2D::Facets::get_point(int index) const
@@ -964,34 +945,13 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
-        int index(0);
-        for (vector<shared_ptr<Point_2D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-        {
-            if (matches(*p1, **p_it))
-                p1_index = index;
-            else if (matches(*p2, **p_it))
-                p2_index = index;
-            else if (matches(*p3, **p_it))
-                p3_index = index;
-            ++index;
-        }
+        find_points(*p1, *p2, *p3, p1_index, p2_index, p3_index);
         if (p1_index == -1)
-        {
-            point_list.push_back(p1);
-            p1_index = index;
-            ++index;
-        }
+            p1_index = add_point(p1);
         if (p2_index == -1)
-        {
-            point_list.push_back(p2);
-            p2_index = index;
-            ++index;
-        }
+            p2_index = add_point(p2);
         if (p3_index == -1)
-        {
-            point_list.push_back(p3);
-            p3_index = index;
-        }
+            p3_index = add_point(p3);
 #ifdef DEBUG_INTERSECT_MESHES_2D_FACETS
         cout << "Intersect_Meshes_2D::Facets::push_back(p1, p2, p3) adding facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
 #endif
@@ -1010,34 +970,14 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
-        int index(0);
-        for (vector<shared_ptr<Point_2D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-        {
-            if (matches(*facet.get_point1(), **p_it))
-                p1_index = index;
-            else if (matches(*facet.get_point2(), **p_it))
-                p2_index = index;
-            else if (matches(*facet.get_point3(), **p_it))
-                p3_index = index;
-            ++index;
-        }
+        find_points(*facet.get_point1(), *facet.get_point2(), *facet.get_point3(), 
+                p1_index, p2_index, p3_index);
         if (p1_index == -1)
-        {
-            point_list.push_back(facet.get_point1());
-            p1_index = index;
-            ++index;
-        }
+            p1_index = add_point(facet.get_point1());
         if (p2_index == -1)
-        {
-            point_list.push_back(facet.get_point2());
-            p2_index = index;
-            ++index;
-        }
+            p2_index = add_point(facet.get_point2());
         if (p3_index == -1)
-        {
-            point_list.push_back(facet.get_point3());
-            p3_index = index;
-        }
+            p3_index = add_point(facet.get_point3());
 #ifdef DEBUG_INTERSECT_MESHES_2D_FACETS
         cout << "Intersect_Meshes_2D::Facets::push_back(facet) adding facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
 #endif
@@ -1060,6 +1000,7 @@ namespace VCAD_lib
     {
         facet_list.clear();
         point_list.clear();
+        point_index.invalidate();
         point_list.insert(point_list.begin(), facets.point_list.begin(),facets.point_list.end());
         facet_list.insert(facet_list.begin(), facets.facet_list.begin(),facets.facet_list.end());
     }
@@ -1069,21 +1010,13 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
+        find_points(*facet.get_point1(), *facet.get_point2(), *facet.get_point3(), 
+                p1_index, p2_index, p3_index);
         
-        int index(0);
-        for (vector<shared_ptr<Point_2D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-        {
-            if (*it == facet.get_point1())
-                p1_index = index;
-            else if (*it == facet.get_point2())
-                p2_index = index;
-            else if (*it == facet.get_point3())
-                p3_index = index;
-            
-            ++index;
-        }
-        
-        if (p1_index == -1 || p2_index == -1 || p3_index == -1)
+        // the facet points must be the list points, not just have the same coordinates
+        if (p1_index == -1 || p2_index == -1 || p3_index == -1 || 
+                point_list[p1_index] != facet.get_point1() || point_list[p2_index] != facet.get_point2() || 
+                point_list[p3_index] != facet.get_point3())
             return false;
         Facet f(p1_index, p2_index, p3_index);
         return facet_list.end() != find(facet_list.begin(), facet_list.end(), f);
@@ -1142,36 +1075,16 @@ namespace VCAD_lib
             int p1_index(-1);
             int p2_index(-1);
             int p3_index(-1);
-            
-            int index(0);
-            for (vector<shared_ptr<Point_2D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-            {
-                if (matches(*new_facets.get_point(it->get_p1_index()), **p_it))
-                    p1_index = index;
-                else if (matches(*new_facets.get_point(it->get_p2_index()), **p_it))
-                    p2_index = index;
-                else if (matches(*new_facets.get_point(it->get_p3_index()), **p_it))
-                    p3_index = index;
-                ++index;
-            }
-
+            find_points(*new_facets.get_point(it->get_p1_index()), 
+                    *new_facets.get_point(it->get_p2_index()), 
+                    *new_facets.get_point(it->get_p3_index()), 
+                    p1_index, p2_index, p3_index);
             if (p1_index == -1)
-            {
-                point_list.push_back(new_facets.get_point(it->get_p1_index()));
-                p1_index = index;
-                ++index;
-            }
+                p1_index = add_point(new_facets.get_point(it->get_p1_index()));
             if (p2_index == -1)
-            {
-                point_list.push_back(new_facets.get_point(it->get_p2_index()));
-                p2_index = index;
-                ++index;
-            }
+                p2_index = add_point(new_facets.get_point(it->get_p2_index()));
             if (p3_index == -1)
-            {
-                point_list.push_back(new_facets.get_point(it->get_p3_index()));
-                p3_index = index;
-            }
+                p3_index = add_point(new_facets.get_point(it->get_p3_index()));
 #ifdef DEBUG_INTERSECT_MESHES_2D_FACETS
             cout << "Intersect_Meshes_2D::Facets::replace_facet inserting facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
 #endif
@@ -1181,36 +1094,16 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
-
-        int index(0);
-        for (vector<shared_ptr<Point_2D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-        {
-            if (matches(*new_facets.get_point(new_facets.begin()->get_p1_index()), **p_it))
-                p1_index = index;
-            else if (matches(*new_facets.get_point(new_facets.begin()->get_p2_index()), **p_it))
-                p2_index = index;
-            else if (matches(*new_facets.get_point(new_facets.begin()->get_p3_index()), **p_it))
-                p3_index = index;
-            ++index;
-        }
-
+        find_points(*new_facets.get_point(new_facets.begin()->get_p1_index()), 
+                *new_facets.get_point(new_facets.begin()->get_p2_index()), 
+                *new_facets.get_point(new_facets.begin()->get_p3_index()), 
+                p1_index, p2_index, p3_index);
         if (p1_index == -1)
-        {
-            point_list.push_back(new_facets.get_point(new_facets.begin()->get_p1_index()));
-            p1_index = index;
-            ++index;
-        }
+            p1_index = add_point(new_facets.get_point(new_facets.begin()->get_p1_index()));
         if (p2_index == -1)
-        {
-            point_list.push_back(new_facets.get_point(new_facets.begin()->get_p2_index()));
-            p2_index = index;
-            ++index;
-        }
+            p2_index = add_point(new_facets.get_point(new_facets.begin()->get_p2_index()));
         if (p3_index == -1)
-        {
-            point_list.push_back(new_facets.get_point(new_facets.begin()->get_p3_index()));
-            p3_index = index;
-        }
+            p3_index = add_point(new_facets.get_point(new_facets.begin()->get_p3_index()));
 #ifdef DEBUG_INTERSECT_MESHES_2D_FACETS
         cout << "Intersect_Meshes_2D::Facets::replace_facet inserting facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
 #endif
@@ -1247,18 +1140,8 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
-        
-        int index(0);
-        for (vector<shared_ptr<Point_2D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-        {
-            if (matches(*facet.get_point1(), **it))
-                p1_index = index;
-            else if (matches(*facet.get_point2(), **it))
-                p2_index = index;
-            else if (matches(*facet.get_point3(), **it))
-                p3_index = index;
-            ++index;
-        }
+        find_points(*facet.get_point1(), *facet.get_point2(), *facet.get_point3(), 
+                p1_index, p2_index, p3_index);
         
         if (p1_index == -1 || p2_index == -1 || p3_index == -1)
         {
@@ -22,10 +22,13 @@
 
 #include <forward_list>
 #include <memory>
+#include <unordered_map>
 #include "Point_2D.h"
 #include "Facet.h"
 #include "Facet_2D.h"
 #include "Mesh_2D.h"
+#include "Point_Grid_3D.h"
+#include "Point_Index.h"
 
 namespace VCAD_lib
 {
@@ -100,7 +103,7 @@ namespace VCAD_lib
              * facet1: the facet1 used in the intersection
              * facet2: the facet2 used in the intersection
              */
-            const bool validate(const Facet_2D& facet1, const Facet_2D& facet2);
+            void validate(const Facet_2D& facet1, const Facet_2D& facet2);
         private:
             vector<Intersect_Point> i_points; // vector to hold intersect points
             /*
@@ -146,14 +149,6 @@ namespace VCAD_lib
                 I_Pt_Data(); // sets num to zero and initializes ip1 and ip2 with null constructor
             };
             
-            class Point_Find {
-            public:
-                Point_Find(const shared_ptr<Point_2D>& point, const Point_2D::Measurement prec);
-                const bool operator()(const shared_ptr<Point_2D>& other_pt);
-            private:
-                const Point_2D::Measurement precision;
-                const shared_ptr<Point_2D> pt;
-            };
         public:
             /*
              * Constructor
@@ -176,6 +171,7 @@ namespace VCAD_lib
             Facet_2D facet1;
             Facet_2D facet2;
             vector<shared_ptr<Point_2D>> generated_pts;
+            Equal_Point_Grid_3D generated_grid; // generated_pts with a z of 0 for finding points within precision
             
             const bool matches(const shared_ptr<Point_2D>& p1, const shared_ptr<Point_2D>& p2) const;
             
@@ -313,10 +309,15 @@ namespace VCAD_lib
         private:
             vector<shared_ptr<Point_2D>> point_list; // list of points
             vector<Facet> facet_list; // list of Facet
-            /*
-             * Checks if the point values are the same
-             */
-            const bool matches(const Point_2D& p1, const Point_2D& p2) const;
+            Point_Index<Point_2D> point_index; // point_list by exact coordinates
+            // find the facet points in point_list (see Point_Index::find_points)
+            void find_points(const Point_2D& p1, const Point_2D& p2, const Point_2D& p3, 
+                    int& p1_index, int& p2_index, int& p3_index) const
+            {
+                point_index.find_points(point_list, p1, p2, p3, p1_index, p2_index, p3_index);
+            }
+            // add a point to point_list and return its index
+            const int add_point(const shared_ptr<Point_2D>& pt) { return point_index.add_point(point_list, pt); }
             /*
              * add a facet by points.  Used in form_side_facets
              */
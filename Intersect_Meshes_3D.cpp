@@ -36,6 +36,11 @@
 #include <stack>
 #include <cmath>
 #include <cfloat>
+#include <limits>
+#include <utility>
+#include "Facet_Tree_3D.h"
+#include "Half_Edge_Mesh.h"
+#include "Parallel_Queries.h"
 
 namespace VCAD_lib
 {
@@ -459,19 +464,11 @@ namespace VCAD_lib
     }
     
     Intersect_Meshes_3D::I_Pt_Locator::I_Pt_Locator(const Point_3D::Measurement prec) : precision(prec), 
-            facet1(), facet2(), generated_pts() {}
+            facet1(), facet2(), generated_pts(), generated_grid(prec) {}
 
     Intersect_Meshes_3D::I_Pt_Locator::I_Pt_Data::I_Pt_Data() : num(0), 
             ip1(), ip2() {}
     
-    Intersect_Meshes_3D::I_Pt_Locator::Point_Find::Point_Find(const shared_ptr<Point_3D>& point, 
-            const Point_3D::Measurement prec) : precision(prec), pt(point) {}
-    
-    const bool Intersect_Meshes_3D::I_Pt_Locator::Point_Find::operator()(const shared_ptr<Point_3D>& other_pt)
-    {
-        return is_equal(*pt, *other_pt, precision);
-    }
-    
     const bool Intersect_Meshes_3D::I_Pt_Locator::matches(const shared_ptr<Point_3D>& p1, 
             const shared_ptr<Point_3D>& p2) const
     {
@@ -496,11 +493,22 @@ namespace VCAD_lib
         {
             loc = side_loc;
             // check existing points for pt value
-            vector<shared_ptr<Point_3D>>::const_iterator it = find_if(generated_pts.begin(), generated_pts.end(), Point_Find(i_pt, precision));
-            if (it != generated_pts.end())
-                i_pt = *it;
+            const int index(generated_grid.find(*i_pt));
+            if (index != -1)
+                i_pt = generated_pts[index];
             else
+            {
                 generated_pts.push_back(i_pt);
+                try
+                {
+                    generated_grid.insert(*i_pt);
+                }
+                catch (...)
+                {
+                    generated_pts.pop_back();
+                    throw;
+                }
+            }
         }
     }
 
@@ -901,69 +909,86 @@ namespace VCAD_lib
 //                (p1_index == facet.p3_index && p2_index == facet.p1_index && p3_index == facet.p2_index);
 //    }
     
-    Intersect_Meshes_3D::Facets::Facets() : point_list(), facet_list() {}
-    
-    Intersect_Meshes_3D::Facets::Facets(const Mesh_3D& mesh) : point_list(), facet_list() 
+    Intersect_Meshes_3D::Facets::Facets() : point_list(), facet_list(), point_index() {}
+    
+    /*
+     * the points and facets are copied as is.  The point values are copied 
+     * into one block so the mesh and its copies are not changed through 
+     * them.  Mesh points can have the same coordinates (see 
+     * Mesh_3D::append), so a point lookup finds the last point with the 
+     * coordinates (see Point_Index).
+     */
+    Intersect_Meshes_3D::Facets::Facets(const Mesh_3D& mesh) : 
+            point_list(), facet_list(mesh.facet_begin(), mesh.facet_end()), point_index(false)
     {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        cout << "Intersect_Meshes_3D::Facets begin\n";
-#endif
-        for (Mesh_3D::const_iterator it = mesh.begin(); it != mesh.end(); ++it)
-        {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-            cout << "Intersect_Meshes_3D::Facets adding facet p1 x: " << it->get_point1()->get_x() << 
-                    " y: " << it->get_point1()->get_y() << " z: " << it->get_point1()->get_z() << 
-                    " p2 x: " << it->get_point2()->get_x() << " y: " << it->get_point2()->get_y() << 
-                    " z: " << it->get_point2()->get_z() << " p3 x: " << it->get_point3()->get_x() << 
-                    " y: " << it->get_point3()->get_y() << " z: " << it->get_point3()->get_z() << "\n";
-#endif
-            int p1_index(-1);
-            int p2_index(-1);
-            int p3_index(-1);
-            int index(0);
-            for (vector<shared_ptr<Point_3D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-            {
-                if (matches(*it->get_point1(), **p_it))
-                    p1_index = index;
-                else if (matches(*it->get_point2(), **p_it))
-                    p2_index = index;
-                else if (matches(*it->get_point3(), **p_it))
-                    p3_index = index;
-                ++index;
-            }
-            if (p1_index == -1)
-            {
-                point_list.push_back(it->get_point1());
-                p1_index = index;
-                ++index;
-            }
-            if (p2_index == -1)
-            {
-                point_list.push_back(it->get_point2());
-                p2_index = index;
-                ++index;
-            }
-            if (p3_index == -1)
-            {
-                point_list.push_back(it->get_point3());
-                p3_index = index;
-            }
-            facet_list.push_back(Facet(p1_index, p2_index, p3_index));
-        }
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        cout << "Intersect_Meshes_3D::Facets end\n";
-#endif
+        shared_ptr<vector<Point_3D>> points(new vector<Point_3D>());
+        points->reserve(mesh.point_end() - mesh.point_begin());
+        for (Mesh_3D::const_point_iterator it = mesh.point_begin(); it != mesh.point_end(); ++it)
+            points->push_back(**it);
+        point_list.reserve(points->size());
+        for (vector<Point_3D>::size_type i = 0; i < points->size(); ++i)
+            point_list.push_back(shared_ptr<Point_3D>(points, &(*points)[i]));
     }
 
     void Intersect_Meshes_3D::Facets::clear()
     {
         facet_list.clear();
         point_list.clear();
+        point_index.clear();
     }
     
-    const bool Intersect_Meshes_3D::Facets::matches(const Point_3D& p1, const Point_3D& p2) const
+    Intersect_Meshes_3D::Result_Facets::Result_Facets(const Facets& facets1, const Facets& facets2) : 
+            coords(), indices(), facets2_offset(facets1.pts_cend() - facets1.pts_cbegin())
     {
-        return p1.get_x() == p2.get_x() && p1.get_y() == p2.get_y() && p1.get_z() == p2.get_z();
+        coords.reserve(3 * (facets2_offset + (facets2.pts_cend() - facets2.pts_cbegin())));
+        for (Facets::pt_const_iterator it = facets1.pts_cbegin(); it != facets1.pts_cend(); ++it)
+        {
+            coords.push_back((*it)->get_x());
+            coords.push_back((*it)->get_y());
+            coords.push_back((*it)->get_z());
+        }
+        for (Facets::pt_const_iterator it = facets2.pts_cbegin(); it != facets2.pts_cend(); ++it)
+        {
+            coords.push_back((*it)->get_x());
+            coords.push_back((*it)->get_y());
+            coords.push_back((*it)->get_z());
+        }
+    }
+    
+    void Intersect_Meshes_3D::Result_Facets::push_back_facet1(const Facet& facet)
+    {
+        indices.push_back(facet.get_p1_index());
+        indices.push_back(facet.get_p2_index());
+        indices.push_back(facet.get_p3_index());
+    }
+    
+    void Intersect_Meshes_3D::Result_Facets::push_back_facet2(const Facet& facet)
+    {
+        indices.push_back(facets2_offset + facet.get_p1_index());
+        indices.push_back(facets2_offset + facet.get_p2_index());
+        indices.push_back(facets2_offset + facet.get_p3_index());
+    }
+    
+    void Intersect_Meshes_3D::Result_Facets::push_back_inverted_facet2(const Facet& facet)
+    {
+        // invert unit normal vector by swapping p2 and p3
+        indices.push_back(facets2_offset + facet.get_p1_index());
+        indices.push_back(facets2_offset + facet.get_p3_index());
+        indices.push_back(facets2_offset + facet.get_p2_index());
+    }
+    
+    void Intersect_Meshes_3D::Result_Facets::move_to(Mesh_3D& mesh) const
+    {
+        Mesh_3D temp(mesh.get_precision(), coords, indices);
+        // facets1 and facets2 have the points where they intersect in common
+        temp.merge_duplicate_points();
+        temp.remove_unused_points();
+        if (mesh.get_weld_points())
+        {
+            temp.weld(mesh.get_precision());
+            temp.set_weld_points(true);
+        }
+        mesh = move(temp);
     }
     
     const shared_ptr<Point_3D> Intersect_Meshes_3D::Facets::get_point(int index) const
@@ -984,34 +1009,14 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
-        int index(0);
-        for (vector<shared_ptr<Point_3D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-        {
-            if (matches(*facet.get_point1(), **p_it))
-                p1_index = index;
-            else if (matches(*facet.get_point2(), **p_it))
-                p2_index = index;
-            else if (matches(*facet.get_point3(), **p_it))
-                p3_index = index;
-            ++index;
-        }
+        find_points(*facet.get_point1(), *facet.get_point2(), *facet.get_point3(), 
+                p1_index, p2_index, p3_index);
         if (p1_index == -1)
-        {
-            point_list.push_back(facet.get_point1());
-            p1_index = index;
-            ++index;
-        }
+            p1_index = add_point(facet.get_point1());
         if (p2_index == -1)
-        {
-            point_list.push_back(facet.get_point2());
-            p2_index = index;
-            ++index;
-        }
+            p2_index = add_point(facet.get_point2());
         if (p3_index == -1)
-        {
-            point_list.push_back(facet.get_point3());
-            p3_index = index;
-        }
+            p3_index = add_point(facet.get_point3());
 #ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
         cout << "Intersect_Meshes_3D::Facets::push_back(facet) adding facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
 #endif
@@ -1034,6 +1039,7 @@ namespace VCAD_lib
     {
         facet_list.clear();
         point_list.clear();
+        point_index.invalidate();
         point_list.insert(point_list.begin(), facets.point_list.begin(),facets.point_list.end());
         facet_list.insert(facet_list.begin(), facets.facet_list.begin(),facets.facet_list.end());
     }
@@ -1043,172 +1049,58 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
+        find_points(*facet.get_point1(), *facet.get_point2(), *facet.get_point3(), 
+                p1_index, p2_index, p3_index);
         
-        int index(0);
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-        {
-            if (*it == facet.get_point1())
-                p1_index = index;
-            else if (*it == facet.get_point2())
-                p2_index = index;
-            else if (*it == facet.get_point3())
-                p3_index = index;
-            
-            ++index;
-        }
-        
-        if (p1_index == -1 || p2_index == -1 || p3_index == -1)
+        // the facet points must be the list points, not just have the same coordinates
+        if (p1_index == -1 || p2_index == -1 || p3_index == -1 || 
+                point_list[p1_index] != facet.get_point1() || point_list[p2_index] != facet.get_point2() || 
+                point_list[p3_index] != facet.get_point3())
             return false;
         Facet f(p1_index, p2_index, p3_index);
         return facet_list.end() != find(facet_list.begin(), facet_list.end(), f);
     }
     
-    Intersect_Meshes_3D::Facets::const_iterator Intersect_Meshes_3D::Facets::replace_facet(
-            const Facet facet, const Facets& new_facets)
+    void Intersect_Meshes_3D::Facets::replace_facets(const vector<shared_ptr<Facets>>& new_facets)
     {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        cout << "Intersect_Meshes_3D::Facets::replace_facet begin\n";
-        cout << "Intersect_Meshes_3D::Facets::replace_facet facet p1(" << facet.get_p1_index() << ") x: " << 
-                this->get_point(facet.get_p1_index())->get_x() << " y: " << this->get_point(facet.get_p1_index())->get_y() << 
-                " z: " << this->get_point(facet.get_p1_index())->get_z() << " p2(" << facet.get_p2_index() << 
-                ") x: " << this->get_point(facet.get_p2_index())->get_x() << " y: " << this->get_point(facet.get_p2_index())->get_y() << 
-                " z: " << this->get_point(facet.get_p2_index())->get_z() << " p3(" << facet.get_p3_index() << ") x: " << 
-                this->get_point(facet.get_p3_index())->get_x() << " y: " << this->get_point(facet.get_p3_index())->get_y() << 
-                " z: " << this->get_point(facet.get_p3_index())->get_z() << "\n"; 
-        int count = 0;
-        for (vector<Facet>::const_iterator it = facet_list.begin(); it != facet_list.end(); ++it)
-        {
-            cout << "Intersect_Meshes_3D::Facets::replace_facet before facets[" << count << "] p1: " << it->get_p1_index() << 
-                    " p2: " << it->get_p2_index() << " p3: " << it->get_p3_index() << "\n";
-            ++count;
-        }
-#endif        
-        vector<Facet>::const_iterator f_loc = find(facet_list.begin(), facet_list.end(), facet);
-        
-        if (f_loc == facet_list.end())
-            throw runtime_error("Unable to locate facet");
-        
-        // remove Facet at f_loc
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        cout << "Intersect_Meshes_3D::Facets::replace_facet f_loc p1: " << f_loc->get_p1_index() << " p2: " << 
-                f_loc->get_p2_index() << " p3: " << f_loc->get_p3_index() << "\n";
-        cout << "Intersect_Meshes_3D::Facets::replace_facet erasing f_loc facets size: " << facet_list.size() << "\n";
-#endif
-            
-        f_loc = facet_list.erase(f_loc); // f_loc now points to the facet just after the one removed
-
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        cout << "Intersect_Meshes_3D::Facets::replace_facet erased f_loc facets size: " << facet_list.size() << "\n";
-        count = 0;
-        for (vector<Facet>::const_iterator it = facet_list.begin(); it != facet_list.end(); ++it)
+        vector<Facet>::size_type new_size(0);
+        for (vector<Facet>::size_type index = 0; index < facet_list.size(); ++index)
+            new_size += new_facets[index] ? new_facets[index]->size() : 1;
+        vector<Facet> new_facet_list;
+        new_facet_list.reserve(new_size);
+        for (vector<Facet>::size_type index = 0; index < facet_list.size(); ++index)
         {
-            cout << "Intersect_Meshes_3D::Facets::replace_facet after erase facets[" << count << "] p1: " << it->get_p1_index() << 
-                    " p2: " << it->get_p2_index() << " p3: " << it->get_p3_index() << "\n";
-            ++count;
-        }
-        if (f_loc != facet_list.end())
-            cout << "Intersect_Meshes_3D::Facets::replace_facet f_loc p1: " << f_loc->get_p1_index() << 
-                    " p2: " << f_loc->get_p2_index() << " p3: " << f_loc->get_p3_index() << "\n";
-        else
-            cout << "Intersect_Meshes_3D::Facets::replace_facet f_loc == facets.end\n";
-#endif
-        
-        for (Facets::const_iterator it = --new_facets.end(); it != new_facets.begin(); --it)
-        {
-            int p1_index(-1);
-            int p2_index(-1);
-            int p3_index(-1);
-            
-            int index(0);
-            for (vector<shared_ptr<Point_3D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-            {
-                if (matches(*new_facets.get_point(it->get_p1_index()), **p_it))
-                    p1_index = index;
-                else if (matches(*new_facets.get_point(it->get_p2_index()), **p_it))
-                    p2_index = index;
-                else if (matches(*new_facets.get_point(it->get_p3_index()), **p_it))
-                    p3_index = index;
-                ++index;
-            }
-
-            if (p1_index == -1)
-            {
-                point_list.push_back(new_facets.get_point(it->get_p1_index()));
-                p1_index = index;
-                ++index;
-            }
-            if (p2_index == -1)
-            {
-                point_list.push_back(new_facets.get_point(it->get_p2_index()));
-                p2_index = index;
-                ++index;
-            }
-            if (p3_index == -1)
+            if (!new_facets[index])
             {
-                point_list.push_back(new_facets.get_point(it->get_p3_index()));
-                p3_index = index;
+                new_facet_list.push_back(facet_list[index]);
+                continue;
             }
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-            cout << "Intersect_Meshes_3D::Facets::replace_facet inserting facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
-#endif
-            f_loc = facet_list.insert(f_loc, Facet(p1_index, p2_index, p3_index));
-        }
-
-        int p1_index(-1);
-        int p2_index(-1);
-        int p3_index(-1);
-
-        int index(0);
-        for (vector<shared_ptr<Point_3D>>::const_iterator p_it = point_list.begin(); p_it != point_list.end(); ++p_it)
-        {
-            if (matches(*new_facets.get_point(new_facets.begin()->get_p1_index()), **p_it))
-                p1_index = index;
-            else if (matches(*new_facets.get_point(new_facets.begin()->get_p2_index()), **p_it))
-                p2_index = index;
-            else if (matches(*new_facets.get_point(new_facets.begin()->get_p3_index()), **p_it))
-                p3_index = index;
-            ++index;
-        }
-
-        if (p1_index == -1)
-        {
-            point_list.push_back(new_facets.get_point(new_facets.begin()->get_p1_index()));
-            p1_index = index;
-            ++index;
-        }
-        if (p2_index == -1)
-        {
-            point_list.push_back(new_facets.get_point(new_facets.begin()->get_p2_index()));
-            p2_index = index;
-            ++index;
-        }
-        if (p3_index == -1)
-        {
-            point_list.push_back(new_facets.get_point(new_facets.begin()->get_p3_index()));
-            p3_index = index;
-        }
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        cout << "Intersect_Meshes_3D::Facets::replace_facet inserting facet p1: " << p1_index << " p2: " << p2_index << " p3: " << p3_index << "\n";
-#endif
-        f_loc = facet_list.insert(f_loc, Facet(p1_index, p2_index, p3_index));
-        
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACETS
-        count = 0;
-        for (vector<Facet>::const_iterator it = facet_list.begin(); it != facet_list.end(); ++it)
-        {
-            cout << "Intersect_Meshes_3D::Facets::replace_facet after facets[" << count << "] p1: " << it->get_p1_index() << 
-                    " p2: " << it->get_p2_index() << " p3: " << it->get_p3_index() << "\n";
-            ++count;
-        }
-        
-        if (f_loc != facet_list.end())
-            cout << "Intersect_Meshes_3D::Facets::replace_facet f_loc p1: " << f_loc->get_p1_index() << 
-                    " p2: " << f_loc->get_p2_index() << " p3: " << f_loc->get_p3_index() << "\n";
-        else
-            cout << "Intersect_Meshes_3D::Facets::replace_facet f_loc == facets.end\n";
-        cout << "Intersect_Meshes_3D::Facets::replace_facet end. returning f_loc\n";
-#endif
-        return f_loc;
+            
+            // add the points from the last new facet to the first, the 
+            // order the result point lists have always been built in
+            const Facets& facets(*new_facets[index]);
+            const vector<Facet>::size_type first(new_facet_list.size());
+            new_facet_list.insert(new_facet_list.end(), facets.facet_list.begin(), facets.facet_list.end());
+            for (vector<Facet>::size_type new_index = facets.size(); new_index-- > 0;)
+            {
+                const Facet& facet(facets.facet_list[new_index]);
+                int p1_index(-1);
+                int p2_index(-1);
+                int p3_index(-1);
+                find_points(*facets.get_point(facet.get_p1_index()), 
+                        *facets.get_point(facet.get_p2_index()), 
+                        *facets.get_point(facet.get_p3_index()), 
+                        p1_index, p2_index, p3_index);
+                if (p1_index == -1)
+                    p1_index = add_point(facets.get_point(facet.get_p1_index()));
+                if (p2_index == -1)
+                    p2_index = add_point(facets.get_point(facet.get_p2_index()));
+                if (p3_index == -1)
+                    p3_index = add_point(facets.get_point(facet.get_p3_index()));
+                new_facet_list[first + new_index] = Facet(p1_index, p2_index, p3_index);
+            }
+        }
+        facet_list.swap(new_facet_list);
     }
     
     const Facet Intersect_Meshes_3D::Facets::find_facet(const Facet_3D& facet) const
@@ -1224,18 +1116,8 @@ namespace VCAD_lib
         int p1_index(-1);
         int p2_index(-1);
         int p3_index(-1);
-        
-        int index(0);
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-        {
-            if (matches(*facet.get_point1(), **it))
-                p1_index = index;
-            else if (matches(*facet.get_point2(), **it))
-                p2_index = index;
-            else if (matches(*facet.get_point3(), **it))
-                p3_index = index;
-            ++index;
-        }
+        find_points(*facet.get_point1(), *facet.get_point2(), *facet.get_point3(), 
+                p1_index, p2_index, p3_index);
         
         if (p1_index == -1 || p2_index == -1 || p3_index == -1)
         {
@@ -3140,8 +3022,75 @@ namespace VCAD_lib
         }
     }
     
-    Intersect_Meshes_3D::Facet_Sorter::Facet_Sorter(const Point_3D::Measurement& prec) : precision(prec), f1_on_surface_f2(), 
-            f1_inside_f2(), f2_on_surface_f1(), f2_inside_f1() {}
+    Intersect_Meshes_3D::Facet_Sorter::Sort_Facets::Sort_Facets(const Facets& f, 
+            const Point_3D::Measurement precision) : facets(f), bounds(facet_bounds(f, precision)), 
+            tree(bounds), fast_facets()
+    {
+        fast_facets.reserve(facets.size());
+        for (Facets::size_type index = 0; index < facets.size(); ++index)
+            fast_facets.push_back(Fast_Facet_3D(point(index, 0), point(index, 1), point(index, 2)));
+    }
+    
+    const Point_3D& Intersect_Meshes_3D::Facet_Sorter::Sort_Facets::point(const Facets::size_type index, 
+            const int pt) const
+    {
+        const Facet& facet(facets.begin()[index]);
+        const int pt_index(pt == 0 ? facet.get_p1_index() : pt == 1 ? facet.get_p2_index() : facet.get_p3_index());
+        return *facets.pts_cbegin()[pt_index];
+    }
+    
+    const vector<Point_3D::Measurement> Intersect_Meshes_3D::Facet_Sorter::Sort_Facets::facet_bounds(
+            const Facets& f, const Point_3D::Measurement precision)
+    {
+        vector<Point_3D::Measurement> bounds;
+        bounds.reserve(6 * f.size());
+        for (Facets::const_iterator it = f.begin(); it != f.end(); ++it)
+        {
+            const Point_3D& p1(*f.pts_cbegin()[it->get_p1_index()]);
+            const Point_3D& p2(*f.pts_cbegin()[it->get_p2_index()]);
+            const Point_3D& p3(*f.pts_cbegin()[it->get_p3_index()]);
+            bounds.push_back(min(p1.get_x(), min(p2.get_x(), p3.get_x())) - precision);
+            bounds.push_back(min(p1.get_y(), min(p2.get_y(), p3.get_y())) - precision);
+            bounds.push_back(min(p1.get_z(), min(p2.get_z(), p3.get_z())) - precision);
+            bounds.push_back(max(p1.get_x(), max(p2.get_x(), p3.get_x())) + precision);
+            bounds.push_back(max(p1.get_y(), max(p2.get_y(), p3.get_y())) + precision);
+            bounds.push_back(max(p1.get_z(), max(p2.get_z(), p3.get_z())) + precision);
+        }
+        return bounds;
+    }
+    
+    Intersect_Meshes_3D::Facet_Sorter::Closest_Hit::Closest_Hit(const Sort_Facets& f, const Point_3D& o, 
+            const Vector_3D& v, const Point_3D::Measurement prec) : sort_facets(f), origin(o), 
+            direction(v), precision(prec), facet(-1), on_side(false), 
+            closest(numeric_limits<Point_3D::Measurement>::infinity()) {}
+    
+    const Point_3D::Measurement Intersect_Meshes_3D::Facet_Sorter::Closest_Hit::operator()(const int index)
+    {
+        const Point_3D::Measurement infinity(numeric_limits<Point_3D::Measurement>::infinity());
+        const Fast_Facet_3D& fast_facet(sort_facets.fast_facets[index]);
+        if (!fast_facet.is_valid())
+            return infinity;
+        const Vector_3D& unv(fast_facet.get_unv());
+        const Point_3D::Measurement denominator(dot_product(unv, direction));
+        if (denominator == 0) // ray is parallel to facet plane
+            return infinity;
+        const Point_3D::Measurement t((fast_facet.get_offset() - unv.get_x() * origin.get_x() - 
+                unv.get_y() * origin.get_y() - unv.get_z() * origin.get_z()) / denominator);
+        if (!(t > 0) || t >= closest)
+            return infinity;
+        const Point_3D i_point(origin.get_x() + t * direction.get_x(), 
+                origin.get_y() + t * direction.get_y(), origin.get_z() + t * direction.get_z());
+        bool pt_on_side(false);
+        if (!fast_facet.contains_point(i_point, pt_on_side, precision))
+            return infinity;
+        facet = index;
+        on_side = pt_on_side;
+        closest = t;
+        return t;
+    }
+    
+    Intersect_Meshes_3D::Facet_Sorter::Facet_Sorter(const Point_3D::Measurement& prec) : precision(prec), 
+            f1_locations(), f2_locations() {}
     
     void Intersect_Meshes_3D::Facet_Sorter::sort(const Facets& facets1, 
             const Facets& facets2)
@@ -3149,253 +3098,216 @@ namespace VCAD_lib
 #ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
         cout << "Intersect_Meshes_3D::Facet_Sorter::sort begin\n";
 #endif
-        // consider all f1 facets inside f2 and remove them if they are found to be outside
-        for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
+        const Sort_Facets sort_facets1(facets1, precision);
+        const Sort_Facets sort_facets2(facets2, precision);
+        vector<Facet_Location> locations1(facets1.size(), outside_mesh);
+        vector<Facet_Location> locations2(facets2.size(), outside_mesh);
+        vector<int> surface_facets;
+        
+        locate_facets(sort_facets1, sort_facets2, locations1, surface_facets);
+        // the facets2 facet an f1 facet is on is also on the surface of facets1
+        for (vector<int>::const_iterator it = surface_facets.begin(); it != surface_facets.end(); ++it)
         {
-            f1_inside_f2.push_back(*it);
+            if (*it != -1)
+                locations2[*it] = on_mesh_surface;
         }
         
-        vector<Facet> unchecked_f2_facets;
-        // consider all f2 facets inside f1 and remove them if they are found to be outside
-        for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
+        locate_facets(sort_facets2, sort_facets1, locations2, surface_facets);
+        // an f1 facet that an f2 facet is on is not inside facets2
+        for (vector<int>::const_iterator it = surface_facets.begin(); it != surface_facets.end(); ++it)
         {
-            f2_inside_f1.push_back(*it);
-            unchecked_f2_facets.push_back(*it);
+            if (*it != -1 && locations1[*it] == inside_mesh)
+                locations1[*it] = outside_mesh;
         }
         
+        f1_locations.swap(locations1);
+        f2_locations.swap(locations2);
 #ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-        cout << "Intersect_Meshes_3D::Facet_Sorter::sort beginning first round\n";
+        cout << "Intersect_Meshes_3D::Facet_Sorter::sort end\n";
 #endif
-        for (Facets::const_iterator f1_it = facets1.begin(); f1_it != facets1.end(); ++f1_it)
+    }
+    
+    void Intersect_Meshes_3D::Facet_Sorter::locate_facets(const Sort_Facets& sort_facets, 
+            const Sort_Facets& other, vector<Facet_Location>& locations, vector<int>& surface_facets) const
+    {
+        const Facets& facets(sort_facets.facets);
+        surface_facets.assign(facets.size(), -1);
+        
+        // facets whose box overlaps a facet box of the other mesh
+        vector<bool> near(facets.size(), false);
+        vector<int> overlaps;
+        for (Facets::size_type index = 0; index < facets.size(); ++index)
         {
-            const Facet_3D f1(facets1.get_point(f1_it->get_p1_index()), facets1.get_point(f1_it->get_p2_index()), facets1.get_point(f1_it->get_p3_index()));
-            const Point_3D f1_ip(f1.get_inside_point());
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-            cout << "Intersect_Meshes_3D::Facet_Sorter::sort sorting facets1 facet (p1: " << 
-                    f1_it->get_p1_index() << " p2: " << f1_it->get_p2_index() << " p3: " << 
-                    f1_it->get_p3_index() << ") p1 x: " << f1.get_point1()->get_x() << " y: " << 
-                    f1.get_point1()->get_y() << " z: " << f1.get_point1()->get_z() << " p2 x: " << 
-                    f1.get_point2()->get_x() << " y: " << f1.get_point2()->get_y() << " z: " << 
-                    f1.get_point2()->get_z() << " p3 x: " << f1.get_point3()->get_x() << " y: " << 
-                    f1.get_point3()->get_y() << " z: " << f1.get_point3()->get_z() << 
-                    " internal point is x: " << f1_ip.get_x() << " y: " << f1_ip.get_y() << " z: " << 
-                    f1_ip.get_z() << "\n";
-#endif
-            // determine if point is on or inside the mesh
-            bool outside_mesh = false;
-            for (Facets::const_iterator f2_it = facets2.begin(); f2_it != facets2.end(); ++f2_it)
-            {
-                const Facet_3D f2(facets2.get_point(f2_it->get_p1_index()), facets2.get_point(f2_it->get_p2_index()), facets2.get_point(f2_it->get_p3_index()));
-                // if point is on a facet, return true
-                bool pt_on_side(false);
-                if (f2.contains_point(f1_ip, pt_on_side, precision))
-                {
+            const vector<Point_3D::Measurement>& b(sort_facets.bounds);
+            overlaps.clear();
+            other.tree.find_overlaps(Point_3D(b[6 * index], b[6 * index + 1], b[6 * index + 2]), 
+                    Point_3D(b[6 * index + 3], b[6 * index + 4], b[6 * index + 5]), overlaps);
+            near[index] = !overlaps.empty();
+        }
+        
+        const Half_Edge_Mesh half_edges(facets.begin(), facets.end());
+        vector<bool> located(facets.size(), false);
+        vector<int> region;
+        for (Facets::size_type index = 0; index < facets.size(); ++index)
+        {
+            if (located[index])
+                continue;
+            located[index] = true;
+            if (locations[index] == on_mesh_surface) // already found by the other mesh
+                continue;
+            
+            const Point_3D inside_pt(facet_inside_point(sort_facets.point(index, 0), 
+                    sort_facets.point(index, 1), sort_facets.point(index, 2)));
 #ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-                    cout << "Intersect_Meshes_3D::Facet_Sorter::sort sorting facets1 facet p1: " << 
-                            f1_it->get_p1_index() << " p2: " << f1_it->get_p2_index() << " p3: " << 
-                            f1_it->get_p3_index() << " internal point is on surface of f2 p1: " << 
-                            f2_it->get_p1_index() << " p2: " << f2_it->get_p2_index() << " p3: " << 
-                            f2_it->get_p3_index() << "\n";
-#endif
-                    // both f1 and f2 are on the surface of each other
-                    f1_on_surface_f2.push_back(*f1_it);
-                    f2_on_surface_f1.push_back(*f2_it);
-                    // remove f1 facet from inside
-                    vector<Facet>::const_iterator it = find(f1_inside_f2.begin(), f1_inside_f2.end(), *f1_it);
-                    if (it != f1_inside_f2.end())
-                        f1_inside_f2.erase(it); // remove from list since it is on the f1 mesh
-                    // remove f2 facet from inside
-                    it = find(f2_inside_f1.begin(), f2_inside_f1.end(), *f2_it);
-                    if (it != f2_inside_f1.end())
-                        f2_inside_f1.erase(it); // remove from list since it is on the f1 mesh
-                    // remove f2 facet from unchecked
-                    it = find(unchecked_f2_facets.begin(), unchecked_f2_facets.end(), *f2_it);
-                    if (it != unchecked_f2_facets.end())
-                        unchecked_f2_facets.erase(it); // remove from list since it is on the f1 mesh
-                    break; // go to next f1
-                }
-                else if (outside_mesh) // if already found to be outside, 
-                    continue;          // see if point is on a facet - no need to look if outside anymore
-
-                // determine if point is inside mesh by checking if 
-                // point is behind each closest facet
-
-                // vector from point to facet
-                const Point_3D f2_ip(f2.get_inside_point());
-                Vector_3D v(f1_ip, f2_ip);
-                bool closer_facet = false; // if there is a facet that is closer
-
-                // go through mesh again looking for possible facets that are closer
-                Point_3D i_point(0,0,0); // initialize here so it will be only assigned in loop
-                for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
-                {
-                    if (it == f2_it) // don't process the same facet
-                        continue;
-                    // check if facet is in the same general direction and closer 
-                    // than the *f2_it facet
-                    // see if line v from p intersects *it facet
-                    Facet_3D f(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index()));
-                    if (intersect_line_facet_plane(v, f1_ip, f, i_point, precision) && 
-                            is_pt_on_vector(i_point, f1_ip, f2_ip, precision) && 
-                            f.contains_point(i_point, pt_on_side, precision))
-                    {
-                        // closer facet
-                        closer_facet = true;
-                        break;
-                    }
-                }
-
-                if (!closer_facet) // this is the closest facet, so test
+            const Facet& facet(facets.begin()[index]);
+            cout << "Intersect_Meshes_3D::Facet_Sorter::locate_facets locating facet (p1: " << 
+                    facet.get_p1_index() << " p2: " << facet.get_p2_index() << " p3: " << 
+                    facet.get_p3_index() << ") internal point is x: " << inside_pt.get_x() << 
+                    " y: " << inside_pt.get_y() << " z: " << inside_pt.get_z() << 
+                    (near[index] ? " near" : " far") << " the other mesh\n";
+#endif
+            locations[index] = locate_point(inside_pt, other, surface_facets[index]);
+            if (near[index])
+                continue;
+            
+            // every facet connected to this one without overlapping the other
+            // mesh is on the same side of the other mesh
+            region.assign(1, index);
+            while (!region.empty())
+            {
+                const int f(region.back());
+                region.pop_back();
+                for (int side = 0; side < 3; ++side)
                 {
-                    // if point is in front of facet
-                    if (dot_product(f2.get_unv(), v.normalize()) < 0)
+                    const int side_h(half_edges.facet_half_edge(f) + side);
+                    for (int h = half_edges.edge_half_edge(half_edges.edge(side_h)); h != -1; 
+                            h = half_edges.next_on_edge(h))
                     {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-                        cout << "Intersect_Meshes_3D::Facet_Sorter::sort facets1 facet p1: " << 
-                                f1_it->get_p1_index() << " p2: " << f1_it->get_p2_index() << " p3: " << 
-                                f1_it->get_p3_index() << " internal point is outside of f2 p1: " << 
-                                f2_it->get_p1_index() << " p2: " << f2_it->get_p2_index() << " p3: " << 
-                                f2_it->get_p3_index() << "\n";
-#endif
-                        outside_mesh = true;
-                        // f1 is outside of f2
-                        vector<Facet>::const_iterator it = find(f1_inside_f2.begin(), f1_inside_f2.end(), *f1_it);
-                        if (it != f1_inside_f2.end())
-                            f1_inside_f2.erase(it); // remove from list since it is outside of mesh
-                    }
-                    if (dot_product(f1.get_unv(), -v) < 0)
-                    {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-                        cout << "Intersect_Meshes_3D::Facet_Sorter::sort facets2 facet p1: " << f2_it->get_p1_index() << 
-                                " p2: " << f2_it->get_p2_index() << " p3: " << f2_it->get_p3_index() << 
-                                " internal point is outside of f1 p1: " << f1_it->get_p1_index() << " p2: " << 
-                                f1_it->get_p2_index() << " p3: " << f1_it->get_p3_index() << "\n";
-#endif
-                        // f2 is outside of f1
-                        vector<Facet>::const_iterator it = find(f2_inside_f1.begin(), f2_inside_f1.end(), *f2_it);
-                        if (it != f2_inside_f1.end())
-                            f2_inside_f1.erase(it); // remove from list since it is outside of mesh
-                        it = find(unchecked_f2_facets.begin(), unchecked_f2_facets.end(), *f2_it);
-                        if (it != unchecked_f2_facets.end())
-                            unchecked_f2_facets.erase(it); // remove from list since it is outside of mesh
+                        const int adjacent(half_edges.facet(h));
+                        if (located[adjacent] || near[adjacent] || locations[adjacent] == on_mesh_surface)
+                            continue;
+                        located[adjacent] = true;
+                        locations[adjacent] = locations[index];
+                        region.push_back(adjacent);
                     }
                 }
             }
         }
+    }
+    
+    const Intersect_Meshes_3D::Facet_Sorter::Facet_Location Intersect_Meshes_3D::Facet_Sorter::locate_point(
+            const Point_3D& pt, const Sort_Facets& other, int& surface_facet) const
+    {
+        // if point is on a facet, it is on the surface.  Use the first facet 
+        // containing the point.
+        vector<int> candidates;
+        other.tree.find_overlaps(pt, pt, candidates);
+        std::sort(candidates.begin(), candidates.end());
+        for (vector<int>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            bool pt_on_side(false);
+            if (other.fast_facets[*it].contains_point(pt, pt_on_side, precision))
+            {
+                surface_facet = *it;
+                return on_mesh_surface;
+            }
+        }
         
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-        cout << "Intersect_Meshes_3D::Facet_Sorter::sort beginning second round with " << unchecked_f2_facets.size() << " facets2 facets to sort\n";
-#endif
-        for (vector<Facet>::const_iterator f2_it = unchecked_f2_facets.begin(); f2_it != unchecked_f2_facets.end(); ++f2_it)
+        // determine if point is inside mesh by checking if point is behind the
+        // closest facet along a ray to the inside point of a facet.  If the 
+        // ray hits the closest facet on a side or nearly parallel to the facet,
+        // the next facet is used for the ray.
+        bool outside = false;
+        bool found_facet = false;
+        for (Facets::size_type index = 0; index < other.facets.size(); ++index)
         {
-            const Facet_3D f2(facets2.get_point(f2_it->get_p1_index()), facets2.get_point(f2_it->get_p2_index()), facets2.get_point(f2_it->get_p3_index()));
-            const Point_3D f2_ip(f2.get_inside_point());
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-            cout << "Intersect_Meshes_3D::Facet_Sorter::sort sorting facets2 facet (p1: " << 
-                    f2_it->get_p1_index() << " p2: " << f2_it->get_p2_index() << " p3: " << 
-                    f2_it->get_p3_index() << ") p1 x: " << f2.get_point1()->get_x() << " y: " << 
-                    f2.get_point1()->get_y() << " z: " << f2.get_point1()->get_z() << " p2 x: " << 
-                    f2.get_point2()->get_x() << " y: " << f2.get_point2()->get_y() << " z: " << 
-                    f2.get_point2()->get_z() << " p3 x: " << f2.get_point3()->get_x() << " y: " << 
-                    f2.get_point3()->get_y() << " z: " << f2.get_point3()->get_z() << 
-                    " internal point is x: " << f2_ip.get_x() << " y: " << f2_ip.get_y() << " z: " << 
-                    f2_ip.get_z() << "\n";
-#endif
-            // determine if point is inside the mesh
-            bool outside_mesh = false;
-            for (Facets::const_iterator f1_it = facets1.begin(); f1_it != facets1.end(); ++f1_it)
-            {
-                const Facet_3D f1(facets1.get_point(f1_it->get_p1_index()), facets1.get_point(f1_it->get_p2_index()), facets1.get_point(f1_it->get_p3_index()));
-                // if point is on a facet, return true
-                bool pt_on_side(false);
-                if (f1.contains_point(f2_ip, pt_on_side, precision))
-                {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-                    cout << "Intersect_Meshes_3D::Facet_Sorter::sort sorting facets2 facet p1: " << 
-                            f2_it->get_p1_index() << " p2: " << f2_it->get_p2_index() << " p3: " << 
-                            f2_it->get_p3_index() << " internal point is on surface of f1 p1: " << 
-                            f1_it->get_p1_index() << " p2: " << f1_it->get_p2_index() << " p3: " << 
-                            f1_it->get_p3_index() << "\n";
-#endif
-                    // both f1 and f2 are on the surface of each other
-                    f2_on_surface_f1.push_back(*f2_it);
-                    // remove f1 facet from inside
-                    vector<Facet>::const_iterator it = find(f1_inside_f2.begin(), f1_inside_f2.end(), *f1_it);
-                    if (it != f1_inside_f2.end())
-                        f1_inside_f2.erase(it); // remove from list since it is on the f1 mesh
-                    // remove f2 facet from inside
-                    it = find(f2_inside_f1.begin(), f2_inside_f1.end(), *f2_it);
-                    if (it != f2_inside_f1.end())
-                        f2_inside_f1.erase(it); // remove from list since it is on the f1 mesh
-                    break; // go to next f1
-                }
-                else if (outside_mesh) // if already found to be outside, 
-                    continue;          // see if point is on a facet - no need to look if outside anymore
-
-                // determine if point is inside mesh by checking if 
-                // point is behind each closest facet
-
-                // vector from point to facet
-                const Point_3D f1_ip(f1.get_inside_point());
-                Vector_3D v(f2_ip, f1_ip);
-                bool closer_facet = false; // if there is a facet that is closer
-
-                // go through mesh again looking for possible facets that are closer
-                Point_3D i_point(0,0,0); // initialize here so it will be only assigned in loop
-                for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
-                {
-                    if (it == f1_it) // don't process the same facet
-                        continue;
-                    // check if facet is in the same general direction and closer 
-                    // than the *f1_it facet
-                    // see if line v from p intersects *it facet
-                    pt_on_side = false;
-                    Facet_3D f(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index()));
-                    if (intersect_line_facet_plane(v, f2_ip, f, i_point, precision) && 
-                            is_pt_on_vector(i_point, f2_ip, f1_ip, precision) && 
-                            f.contains_point(i_point, pt_on_side, precision))
-                    {
-                        // closer facet
-                        closer_facet = true;
-                        break;
-                    }
-                }
-
-                if (!closer_facet) // this is the closest facet, so test
-                {
-                    // if point is in front of facet
-                    if (dot_product(f1.get_unv(), v.normalize()) < 0)
-                    {
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-                        cout << "Intersect_Meshes_3D::Facet_Sorter::sort facets2 facet p1: " << 
-                                f2_it->get_p1_index() << " p2: " << f2_it->get_p2_index() << " p3: " << 
-                                f2_it->get_p3_index() << " internal point is outside of f1 p1: " << 
-                                f1_it->get_p1_index() << " p2: " << f1_it->get_p2_index() << " p3: " << 
-                                f1_it->get_p3_index() << "\n";
-#endif
-                        outside_mesh = true;
-                        // f2 is outside of f1
-                        vector<Facet>::const_iterator it = find(f2_inside_f1.begin(), f2_inside_f1.end(), *f2_it);
-                        if (it != f2_inside_f1.end())
-                            f2_inside_f1.erase(it); // remove from list since it is outside of mesh
-                    }
-                }
+            if (!other.fast_facets[index].is_valid())
+                continue;
+            
+            Vector_3D v(pt, facet_inside_point(other.point(index, 0), other.point(index, 1), 
+                    other.point(index, 2)));
+            if (v.length() == 0)
+                continue;
+            v.normalize();
+            Closest_Hit hit(other, pt, v, precision);
+            other.tree.closest_hit(pt, v, hit);
+            if (hit.get_facet() == -1)
+                continue;
+            
+            const Point_3D::Measurement cos_angle(dot_product(other.fast_facets[hit.get_facet()].get_unv(), v));
+            const bool clear_hit(!hit.get_on_side() && fabs(cos_angle) > precision);
+            if (clear_hit || !found_facet)
+            {
+                // if point is in front of facet, point is outside
+                outside = cos_angle < 0;
+                found_facet = true;
             }
+            if (clear_hit)
+                break;
         }
-#ifdef DEBUG_INTERSECT_MESHES_3D_FACET_SORTER
-        cout << "Intersect_Meshes_3D::Facet_Sorter::sort end\n";
-#endif
+        return outside ? outside_mesh : inside_mesh;
     }
     
     void Intersect_Meshes_3D::Facet_Sorter::clear() 
     {
-        f1_inside_f2.clear();
-        f1_on_surface_f2.clear();
-        f2_inside_f1.clear();
-        f2_on_surface_f1.clear();
+        f1_locations.clear();
+        f2_locations.clear();
     }
     
-    Intersect_Meshes_3D::Intersect_Meshes_3D() {}
+    Intersect_Meshes_3D::Intersect_Meshes_3D() : num_threads(1) {}
+    
+    Intersect_Meshes_3D::Intersect_Meshes_3D(const unsigned int threads) : num_threads(threads) {}
+    
+    // box around facet enlarged by precision
+    static void facet_box(const Facet_3D& facet, const Point_3D::Measurement precision, 
+            Point_3D& min_pt, Point_3D& max_pt)
+    {
+        const Point_3D& p1(*facet.get_point1());
+        const Point_3D& p2(*facet.get_point2());
+        const Point_3D& p3(*facet.get_point3());
+        min_pt = Point_3D(min(p1.get_x(), min(p2.get_x(), p3.get_x())) - precision, 
+                min(p1.get_y(), min(p2.get_y(), p3.get_y())) - precision, 
+                min(p1.get_z(), min(p2.get_z(), p3.get_z())) - precision);
+        max_pt = Point_3D(max(p1.get_x(), max(p2.get_x(), p3.get_x())) + precision, 
+                max(p1.get_y(), max(p2.get_y(), p3.get_y())) + precision, 
+                max(p1.get_z(), max(p2.get_z(), p3.get_z())) + precision);
+    }
+    
+    Intersect_Meshes_3D::Intersecting_Facets::Intersecting_Facets(const vector<Facet_Builder>& builders, 
+            const Facet_Tree_3D& tree, const vector<Facet_3D>& facets, 
+            const Point_3D::Measurement prec) : f1_builders(builders), f1_tree(tree), 
+            f2_facets(facets), precision(prec) {}
+    
+    const vector<pair<int,Intersect_Meshes_3D::I_Pt_List>> Intersect_Meshes_3D::Intersecting_Facets::operator()(
+            const size_t index) const
+    {
+        // only facets with overlapping boxes can intersect
+        Point_3D f2_min(0,0,0);
+        Point_3D f2_max(0,0,0);
+        facet_box(f2_facets[index], precision, f2_min, f2_max);
+        vector<int> near_f1;
+        f1_tree.find_overlaps(f2_min, f2_max, near_f1);
+        sort(near_f1.begin(), near_f1.end());
+        
+        I_Pt_Locator i_pt_locator(precision);
+        vector<pair<int,I_Pt_List>> intersecting;
+        for (vector<int>::const_iterator it = near_f1.begin(); it != near_f1.end(); ++it)
+        {
+            I_Pt_List intersect_pts;
+            if (i_pt_locator(f1_builders[*it].get_facet(), f2_facets[index], intersect_pts))
+                intersecting.push_back(pair<int,I_Pt_List>(*it, intersect_pts));
+        }
+        return intersecting;
+    }
+    
+    const shared_ptr<Intersect_Meshes_3D::Facets> Intersect_Meshes_3D::Form_Facets::operator()(
+            const size_t index) const
+    {
+        shared_ptr<Facets> new_facets(new Facets());
+        if (!builders[index].form_new_facets(*new_facets))
+            return shared_ptr<Facets>();
+        return new_facets;
+    }
     
     void Intersect_Meshes_3D::intersect_facets(Facets& facets1, Facets& facets2, 
             const Point_3D::Measurement precision)
@@ -3414,21 +3326,53 @@ namespace VCAD_lib
                     precision));
         }
         
-        I_Pt_Locator i_pt_locator(precision);
+        // only facets with overlapping boxes can intersect
+        vector<Point_3D::Measurement> f1_bounds;
+        f1_bounds.reserve(6 * f1_builders.size());
+        for (vector<Facet_Builder>::const_iterator it = f1_builders.begin(); it != f1_builders.end(); ++it)
+        {
+            Point_3D min_pt(0,0,0);
+            Point_3D max_pt(0,0,0);
+            facet_box(it->get_facet(), precision, min_pt, max_pt);
+            f1_bounds.push_back(min_pt.get_x());
+            f1_bounds.push_back(min_pt.get_y());
+            f1_bounds.push_back(min_pt.get_z());
+            f1_bounds.push_back(max_pt.get_x());
+            f1_bounds.push_back(max_pt.get_y());
+            f1_bounds.push_back(max_pt.get_z());
+        }
+        const Facet_Tree_3D f1_tree(f1_bounds);
+        
+        vector<Facet_3D> f2_facets;
+        f2_facets.reserve(facets2.size());
+        for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
+        {
+            f2_facets.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), 
+                    facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index())));
+        }
         
-        // intersect all facets together
-        Facets::const_iterator f2_it = facets2.begin();
-        while (f2_it != facets2.end())
+        // intersect the facet pairs on several threads.  The intersect 
+        // points are then shared and added to the builders on one thread in 
+        // facets2 then facets1 order, so intersect points are shared between 
+        // facets the same way for any number of threads.
+        vector<vector<pair<int,I_Pt_List>>> intersecting;
+        run_queries(Intersecting_Facets(f1_builders, f1_tree, f2_facets, precision), f2_facets.size(), 
+                intersecting, num_threads, 64);
+        
+        Equal_Point_Grid_3D shared_grid(precision);
+        vector<shared_ptr<Point_3D>> shared_pts;
+        vector<Facet_Builder> f2_builders;
+        f2_builders.reserve(f2_facets.size());
+        for (vector<Facet_3D>::size_type index = 0; index < f2_facets.size(); ++index)
         {
-            Facet_Builder f2_builder(false, 
-                    Facet_3D(facets2.get_point(f2_it->get_p1_index()), 
-                            facets2.get_point(f2_it->get_p2_index()),
-                            facets2.get_point(f2_it->get_p3_index())), 
-                    precision);
-            
-            // intersect all of facets1 with facets2 facet
-            for (vector<Facet_Builder>::iterator f1_it = f1_builders.begin(); f1_it != f1_builders.end(); ++f1_it)
+            f2_builders.push_back(Facet_Builder(false, f2_facets[index], precision));
+            Facet_Builder& f2_builder(f2_builders.back());
+            for (vector<pair<int,I_Pt_List>>::iterator near_it = intersecting[index].begin(); 
+                    near_it != intersecting[index].end(); ++near_it)
             {
+                vector<Facet_Builder>::iterator f1_it(f1_builders.begin() + near_it->first);
+                I_Pt_List& intersect_pts(near_it->second);
+                share_points(intersect_pts, shared_grid, shared_pts);
 #ifdef DEBUG_INTERSECT_MESHES_3D
                 cout << "intersect_meshes_3D::intersect_facets facet1 p1 x: " << f1_it->get_facet().get_point1()->get_x() << 
                         " y: " << f1_it->get_facet().get_point1()->get_y() << " z: " << f1_it->get_facet().get_point1()->get_z() << 
@@ -3440,113 +3384,106 @@ namespace VCAD_lib
                         f2_builder.get_facet().get_point2()->get_x() << " y: " << f2_builder.get_facet().get_point2()->get_y() << " z: " << 
                         f2_builder.get_facet().get_point2()->get_z() << " p3 x: " << f2_builder.get_facet().get_point3()->get_x() << " y: " << 
                         f2_builder.get_facet().get_point3()->get_y() << " z: " << f2_builder.get_facet().get_point3()->get_z() << "\n";
+                cout << "intersect_meshes_3D::intersect_facets intersect_pts size: " << intersect_pts.size() << "\n";
                 cout.flush();
-#endif
-                I_Pt_List intersect_pts;
-                if (i_pt_locator(f1_it->get_facet(), f2_builder.get_facet(), intersect_pts))
+                for (I_Pt_List::const_iterator ip_it = intersect_pts.begin(); ip_it != intersect_pts.end(); ++ip_it)
                 {
-#ifdef DEBUG_INTERSECT_MESHES_3D
-                    cout << "intersect_meshes_3D::intersect_facets intersect_pts size: " << intersect_pts.size() << "\n";
-                    cout.flush();
-                    for (I_Pt_List::const_iterator ip_it = intersect_pts.begin(); ip_it != intersect_pts.end(); ++ip_it)
-                    {
-                        cout << "intersect_meshes_3D::intersect_facets intersect point x: " << ip_it->pt->get_x() << " y: " << 
-                                ip_it->pt->get_y() << " z: " << ip_it->pt->get_z() << " f1_loc: " << ip_it->f1_loc << 
-                                " f2_loc: " << ip_it->f2_loc << "\n";
-                        cout.flush();
-                    }
-                    cout << "intersect_meshes_3D::intersect_facets adding intersection to facets1 facet builder\n";
+                    cout << "intersect_meshes_3D::intersect_facets intersect point x: " << ip_it->pt->get_x() << " y: " << 
+                            ip_it->pt->get_y() << " z: " << ip_it->pt->get_z() << " f1_loc: " << ip_it->f1_loc << 
+                            " f2_loc: " << ip_it->f2_loc << "\n";
                     cout.flush();
+                }
+                cout << "intersect_meshes_3D::intersect_facets adding intersection to facets1 facet builder\n";
+                cout.flush();
 #endif                    
-                    // add intersection to f1 facet
-                    f1_it->add_intersection(intersect_pts);
+                // add intersection to f1 facet
+                f1_it->add_intersection(intersect_pts);
 #ifdef DEBUG_INTERSECT_MESHES_3D
-                    cout << "intersect_meshes_3D::intersect_facets adding intersection to facets2 facet builder\n";
-                    cout.flush();
+                cout << "intersect_meshes_3D::intersect_facets adding intersection to facets2 facet builder\n";
+                cout.flush();
 #endif                    
-                    // add intersection to f2_facet
-                    f2_builder.add_intersection(intersect_pts);
-                }
+                // add intersection to f2_facet
+                f2_builder.add_intersection(intersect_pts);
             }
-            
+        }
+        
+        // form the new facets of each facet on several threads
+        vector<shared_ptr<Facets>> f2_new_facets;
+        run_queries(Form_Facets(f2_builders), f2_builders.size(), f2_new_facets, num_threads, 16);
+        vector<shared_ptr<Facets>> f1_new_facets;
+        run_queries(Form_Facets(f1_builders), f1_builders.size(), f1_new_facets, num_threads, 16);
+        
+        // replace the intersected facets2 facets
 #ifdef DEBUG_INTERSECT_MESHES_3D
-            cout << "intersect_meshes_3D::intersect_facets forming new facets for facets2 facet\n";
-            cout.flush();
-#endif                    
-            // build facets2 facet
-            Facets new_facets;
-            if (f2_builder.form_new_facets(new_facets))
+        for (vector<shared_ptr<Facets>>::const_iterator it = f2_new_facets.begin(); it != f2_new_facets.end(); ++it)
+        {
+            if (*it)
             {
-#ifdef DEBUG_INTERSECT_MESHES_3D
                 cout << "intersect_meshes_3D::intersect_facets formed new facets for facets2 facet\n";
                 cout.flush();
-                for (Facets::const_iterator it = new_facets.begin(); it != new_facets.end(); ++it)
+                for (Facets::const_iterator nf_it = (*it)->begin(); nf_it != (*it)->end(); ++nf_it)
                 {
-                    shared_ptr<Point_3D> p1(new_facets.get_point(it->get_p1_index()));
-                    shared_ptr<Point_3D> p2(new_facets.get_point(it->get_p2_index()));
-                    shared_ptr<Point_3D> p3(new_facets.get_point(it->get_p3_index()));
+                    shared_ptr<Point_3D> p1((*it)->get_point(nf_it->get_p1_index()));
+                    shared_ptr<Point_3D> p2((*it)->get_point(nf_it->get_p2_index()));
+                    shared_ptr<Point_3D> p3((*it)->get_point(nf_it->get_p3_index()));
                     cout << "        intersect_meshes_3D::intersect_facets new facet p1 x: " << p1->get_x() <<
                             " y: " << p1->get_y() << " z: " << p1->get_z() << " p2 x: " << p2->get_x() <<
                             " y: " << p2->get_y() << " z: " << p2->get_z() << " p3 x: " << p3->get_x() << 
                             " y: " << p3->get_y() << " z: " << p3->get_z() << "\n";
                     cout.flush();
                 }
-#endif                    
-                f2_it = facets2.replace_facet(*f2_it, new_facets);
-                advance(f2_it, new_facets.size());
-            }
-            else
-            {
-#ifdef DEBUG_INTERSECT_MESHES_3D
-                cout << "intersect_meshes_3D::intersect_facets no intersection\n";
-                cout.flush();
-#endif
-                ++f2_it;
             }
         }
+#endif
+        facets2.replace_facets(f2_new_facets);
         
-        // form facets1 facets
-        Facets::const_iterator f1_it = facets1.begin();
-        for (vector<Facet_Builder>::iterator fb1_it = f1_builders.begin(); fb1_it != f1_builders.end(); ++fb1_it)
-        {
+        // replace the intersected facets1 facets
 #ifdef DEBUG_INTERSECT_MESHES_3D
-            cout << "intersect_meshes_3D::intersect_facets forming new facets for facets1 facet p1 x: " << 
-                    fb1_it->get_facet().get_point1()->get_x() << " y: " << fb1_it->get_facet().get_point1()->get_y() << 
-                    " z: " << fb1_it->get_facet().get_point1()->get_z() << " p2 x: " << fb1_it->get_facet().get_point2()->get_x() << 
-                    " y: " << fb1_it->get_facet().get_point2()->get_y() << " z: " << fb1_it->get_facet().get_point2()->get_z() << 
-                    " p3 x: " << fb1_it->get_facet().get_point3()->get_x() << " y: " << fb1_it->get_facet().get_point3()->get_y() << 
-                    " z: " << fb1_it->get_facet().get_point3()->get_z() << "\n";
-            cout.flush();
-#endif                    
-            // build facets1 facet
-            Facets new_facets;
-            if (fb1_it->form_new_facets(new_facets))
+        for (vector<shared_ptr<Facets>>::const_iterator it = f1_new_facets.begin(); it != f1_new_facets.end(); ++it)
+        {
+            if (*it)
             {
-#ifdef DEBUG_INTERSECT_MESHES_3D
                 cout << "intersect_meshes_3D::intersect_facets formed new facets for facets1 facet\n";
                 cout.flush();
-                for (Facets::const_iterator it = new_facets.begin(); it != new_facets.end(); ++it)
+                for (Facets::const_iterator nf_it = (*it)->begin(); nf_it != (*it)->end(); ++nf_it)
                 {
-                    shared_ptr<Point_3D> p1(new_facets.get_point(it->get_p1_index()));
-                    shared_ptr<Point_3D> p2(new_facets.get_point(it->get_p2_index()));
-                    shared_ptr<Point_3D> p3(new_facets.get_point(it->get_p3_index()));
+                    shared_ptr<Point_3D> p1((*it)->get_point(nf_it->get_p1_index()));
+                    shared_ptr<Point_3D> p2((*it)->get_point(nf_it->get_p2_index()));
+                    shared_ptr<Point_3D> p3((*it)->get_point(nf_it->get_p3_index()));
                     cout << "        intersect_meshes_3D::intersect_facets new facet p1 x: " << p1->get_x() <<
                             " y: " << p1->get_y() << " z: " << p1->get_z() << " p2 x: " << p2->get_x() <<
                             " y: " << p2->get_y() << " z: " << p2->get_z() << " p3 x: " << p3->get_x() << 
                             " y: " << p3->get_y() << " z: " << p3->get_z() << "\n";
                     cout.flush();
                 }
-#endif                    
-                f1_it = facets1.replace_facet(*f1_it, new_facets);
-                advance(f1_it, new_facets.size());
             }
+        }
+#endif
+        facets1.replace_facets(f1_new_facets);
+    }
+    
+    void Intersect_Meshes_3D::share_points(I_Pt_List& intersect_pts, Equal_Point_Grid_3D& shared_grid, 
+            vector<shared_ptr<Point_3D>>& shared_pts)
+    {
+        for (I_Pt_List::iterator it = intersect_pts.begin(); it != intersect_pts.end(); ++it)
+        {
+            if (it->f1_loc >= Location::p1 || it->f2_loc >= Location::p1)
+                continue;
+            const int index(shared_grid.find(*it->pt));
+            if (index != -1)
+                it->pt = shared_pts[index];
             else
             {
-#ifdef DEBUG_INTERSECT_MESHES_3D
-                cout << "intersect_meshes_3D::intersect_facets no intersection\n";
-                cout.flush();
-#endif
-                ++f1_it;
+                shared_pts.push_back(it->pt);
+                try
+                {
+                    shared_grid.insert(*it->pt);
+                }
+                catch (...)
+                {
+                    shared_pts.pop_back();
+                    throw;
+                }
             }
         }
     }
@@ -3571,19 +3508,17 @@ namespace VCAD_lib
 #ifdef INTERSECT_MESHES_3D
             cout << "Intersect_Meshes_3D::operator() new facets were generated.  Updating mesh1_result\n";
 #endif
-            mesh1_result.clear();
+            Result_Facets result1_facets(facets1, Facets());
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
-            {
-                mesh1_result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
-            }
+                result1_facets.push_back_facet1(*it);
+            result1_facets.move_to(mesh1_result);
 #ifdef INTERSECT_MESHES_3D
             cout << "Intersect_Meshes_3D::operator() Updating mesh2_result\n";
 #endif
-            mesh2_result.clear();
+            Result_Facets result2_facets(Facets(), facets2);
             for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
-            {
-                mesh2_result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index())));
-            }
+                result2_facets.push_back_facet2(*it);
+            result2_facets.move_to(mesh2_result);
 #ifdef INTERSECT_MESHES_3D
             cout << "Intersect_Meshes_3D::operator() returning true\n";
 #endif
@@ -3646,32 +3581,32 @@ namespace VCAD_lib
 #endif
         Facet_Sorter facet_sorter(result.get_precision());
         facet_sorter.sort(facets1, facets2);
-        result.clear();
+        Result_Facets result_facets(facets1, facets2);
         if (facets1.size() > mesh1.size() || facets2.size() > mesh2.size())
         {
             // add any of facets1 facets that are not on or inside of facets2
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
             {
-                if (facet_sorter.f1_surface_end() == find(facet_sorter.f1_surface_begin(), facet_sorter.f1_surface_end(), *it) &&
-                        facet_sorter.f1_inside_end() == find(facet_sorter.f1_inside_begin(), facet_sorter.f1_inside_end(), *it))
+                if (facet_sorter.f1_location(it - facets1.begin()) == Facet_Sorter::outside_mesh)
                 {
 #ifdef DEBUG_INTERSECT_MESHES_3D_DIFFERENCE
                     cout << "Intersect_Meshes_3D::difference adding facet1 facet (p1: " << it->get_p1_index() << " p2: " << 
                             it->get_p2_index() << " p3: " << it->get_p3_index() << ") because it is outside facets2\n";
 #endif
-                    result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
+                    result_facets.push_back_facet1(*it);
                 }
             }
 
             // add any facets2 facets that are inside facets1 and invert the unit normal vector
-            for (vector<Facet>::const_iterator it = facet_sorter.f2_inside_begin(); it != facet_sorter.f2_inside_end(); ++it)
+            for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
             {
+                if (facet_sorter.f2_location(it - facets2.begin()) != Facet_Sorter::inside_mesh)
+                    continue;
 #ifdef DEBUG_INTERSECT_MESHES_3D_DIFFERENCE
                     cout << "Intersect_Meshes_3D::difference adding facet2 facet (p1: " << it->get_p1_index() << " p2: " << 
                             it->get_p2_index() << " p3: " << it->get_p3_index() << ") because it is inside facets1\n";
 #endif
-                // invert unit normal vector by swapping p2 and p3
-                result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p3_index()), facets2.get_point(it->get_p2_index())));
+                result_facets.push_back_inverted_facet2(*it);
             }
         }
         else
@@ -3681,10 +3616,11 @@ namespace VCAD_lib
             cout << "Intersect_Meshes_3D::difference adding facets from facets2 that are inside facets1\n";
 #endif
             // add any facets from mesh that are inside this facet
-            for (vector<Facet>::const_iterator it = facet_sorter.f2_inside_begin(); it != facet_sorter.f2_inside_end(); ++it)
+            for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
             {
-                // invert unit normal vector by swapping p2 and p3
-                result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p3_index()), facets2.get_point(it->get_p2_index())));
+                if (facet_sorter.f2_location(it - facets2.begin()) != Facet_Sorter::inside_mesh)
+                    continue;
+                result_facets.push_back_inverted_facet2(*it);
             }
 
 #ifdef DEBUG_INTERSECT_MESHES_3D_DIFFERENCE
@@ -3693,13 +3629,13 @@ namespace VCAD_lib
             // remove any of this mesh facets that are inside or on the surface of the other mesh
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
             {
-                if (facet_sorter.f1_surface_end() == find(facet_sorter.f1_surface_begin(), facet_sorter.f1_surface_end(), *it) &&
-                        facet_sorter.f1_inside_end() == find(facet_sorter.f1_inside_begin(), facet_sorter.f1_inside_end(), *it))
+                if (facet_sorter.f1_location(it - facets1.begin()) == Facet_Sorter::outside_mesh)
                 {
-                    result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
+                    result_facets.push_back_facet1(*it);
                 }
             }
         }
+        result_facets.move_to(result);
 #ifdef DEBUG_INTERSECT_MESHES_3D_DIFFERENCE
             cout << "Intersect_Meshes_3D::difference end\n";
 #endif
@@ -3753,31 +3689,32 @@ namespace VCAD_lib
 #endif
         Facet_Sorter facet_sorter(result.get_precision());
         facet_sorter.sort(facets1, facets2);
-        result.clear();
+        Result_Facets result_facets(facets1, facets2);
         if (facets1.size() > mesh1.size() || facets2.size() > mesh2.size())
         {
             // add any t_result facets that are inside or on m_result
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
             {
-                if (facet_sorter.f1_surface_end() != find(facet_sorter.f1_surface_begin(), facet_sorter.f1_surface_end(), *it) ||
-                        facet_sorter.f1_inside_end() != find(facet_sorter.f1_inside_begin(), facet_sorter.f1_inside_end(), *it))
+                if (facet_sorter.f1_location(it - facets1.begin()) != Facet_Sorter::outside_mesh)
                 {
 #ifdef DEBUG_INTERSECT_MESHES_3D_INTERSECTION
                     cout << "Intersect_Meshes_3D::intersection adding facet1 facet (p1: " << it->get_p1_index() << " p2: " << 
                             it->get_p2_index() << " p3: " << it->get_p3_index() << ") because it is not outside facets2\n";
 #endif
-                    result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
+                    result_facets.push_back_facet1(*it);
                 }
             }
 
             // add any facet2 facets that are inside facet1
-            for (Facets::const_iterator it = facet_sorter.f2_inside_begin(); it != facet_sorter.f2_inside_end(); ++it)
+            for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
             {
+                if (facet_sorter.f2_location(it - facets2.begin()) != Facet_Sorter::inside_mesh)
+                    continue;
 #ifdef DEBUG_INTERSECT_MESHES_3D_INTERSECTION
                 cout << "Intersect_Meshes_3D::intersection adding facet2 facet (p1: " << it->get_p1_index() << " p2: " << 
                         it->get_p2_index() << " p3: " << it->get_p3_index() << ") because it is inside facets1\n";
 #endif
-                result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index())));
+                result_facets.push_back_facet2(*it);
             }
         }
         else
@@ -3790,21 +3727,23 @@ namespace VCAD_lib
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
             {
                 // add facets that are inside mesh
-                if (facet_sorter.f1_inside_end() != find(facet_sorter.f1_inside_begin(), facet_sorter.f1_inside_end(), *it) ||
-                        facet_sorter.f1_surface_end() != find(facet_sorter.f1_surface_begin(), facet_sorter.f1_surface_end(), *it))
-                    result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
+                if (facet_sorter.f1_location(it - facets1.begin()) != Facet_Sorter::outside_mesh)
+                    result_facets.push_back_facet1(*it);
             }
             
 #ifdef DEBUG_INTERSECT_MESHES_3D_INTERSECTION
             cout << "Intersect_Meshes_3D::intersection adding facets from facets2 that are inside facets1\n";
 #endif
             // mesh facet is inside this mesh
-            for (Facets::const_iterator it = facet_sorter.f2_inside_begin(); it != facet_sorter.f2_inside_end(); ++it)
+            for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
             {
+                if (facet_sorter.f2_location(it - facets2.begin()) != Facet_Sorter::inside_mesh)
+                    continue;
                 // add facets that are inside mesh
-                result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index())));
+                result_facets.push_back_facet2(*it);
             }
         }
+        result_facets.move_to(result);
 #ifdef DEBUG_INTERSECT_MESHES_3D_INTERSECTION
         cout << "Intersect_Meshes_3D::intersection end\n";
 #endif
@@ -3858,33 +3797,32 @@ namespace VCAD_lib
 #endif
         Facet_Sorter facet_sorter(result.get_precision());
         facet_sorter.sort(facets1, facets2);
-        result.clear();
+        Result_Facets result_facets(facets1, facets2);
         if (facets1.size() > mesh1.size() || facets2.size() > mesh2.size())
         {
             // add any t_result facets that are not inside m_result
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
             {
-                if (facet_sorter.f1_inside_end() == find(facet_sorter.f1_inside_begin(), facet_sorter.f1_inside_end(), *it))
+                if (facet_sorter.f1_location(it - facets1.begin()) != Facet_Sorter::inside_mesh)
                 {
 #ifdef DEBUG_INTERSECT_MESHES_3D_MERGE
                     cout << "Intersect_Meshes_3D::merge adding facet1 facet (p1: " << it->get_p1_index() << " p2: " << 
                             it->get_p2_index() << " p3: " << it->get_p3_index() << ") because it is not inside facets2\n";
 #endif
-                    result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
+                    result_facets.push_back_facet1(*it);
                 }
             }
 
             // add any m_result facets that are not inside or on t_result
             for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
             {
-                if (facet_sorter.f2_inside_end() == find(facet_sorter.f2_inside_begin(), facet_sorter.f2_inside_end(), *it) &&
-                        facet_sorter.f2_surface_end() == find(facet_sorter.f2_surface_begin(), facet_sorter.f2_surface_end(), *it))
+                if (facet_sorter.f2_location(it - facets2.begin()) == Facet_Sorter::outside_mesh)
                 {
 #ifdef DEBUG_INTERSECT_MESHES_3D_MERGE
                     cout << "Intersect_Meshes_3D::merge adding facet2 facet (p1: " << it->get_p1_index() << " p2: " << 
                             it->get_p2_index() << " p3: " << it->get_p3_index() << ") because it is outside facets1\n";
 #endif
-                    result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index())));
+                    result_facets.push_back_facet2(*it);
                 }
             }
         }
@@ -3897,8 +3835,8 @@ namespace VCAD_lib
             // add this mesh facets that are not inside mesh
             for (Facets::const_iterator it = facets1.begin(); it != facets1.end(); ++it)
             {
-                if (facet_sorter.f1_inside_end() == find(facet_sorter.f1_inside_begin(), facet_sorter.f1_inside_end(), *it))
-                    result.push_back(Facet_3D(facets1.get_point(it->get_p1_index()), facets1.get_point(it->get_p2_index()), facets1.get_point(it->get_p3_index())));
+                if (facet_sorter.f1_location(it - facets1.begin()) != Facet_Sorter::inside_mesh)
+                    result_facets.push_back_facet1(*it);
             }
             
 #ifdef DEBUG_INTERSECT_MESHES_3D_MERGE
@@ -3907,14 +3845,153 @@ namespace VCAD_lib
             // add mesh facet that is not inside or on this mesh
             for (Facets::const_iterator it = facets2.begin(); it != facets2.end(); ++it)
             {
-                if (facet_sorter.f2_inside_end() == find(facet_sorter.f2_inside_begin(), facet_sorter.f2_inside_end(), *it) && 
-                        facet_sorter.f2_surface_end() == find(facet_sorter.f2_surface_begin(), facet_sorter.f2_surface_end(), *it))
-                    result.push_back(Facet_3D(facets2.get_point(it->get_p1_index()), facets2.get_point(it->get_p2_index()), facets2.get_point(it->get_p3_index())));
+                if (facet_sorter.f2_location(it - facets2.begin()) == Facet_Sorter::outside_mesh)
+                    result_facets.push_back_facet2(*it);
             }
         }
+        result_facets.move_to(result);
 #ifdef DEBUG_INTERSECT_MESHES_3D_MERGE
         cout << "Intersect_Meshes_3D::merge end\n";
 #endif
     }
+    
+    // add the box around the mesh points to bounds (min x, y, z then max x, y, z)
+    static void add_mesh_bounds(const Mesh_3D& mesh, vector<Point_3D::Measurement>& bounds)
+    {
+        Point_3D::Measurement box[6];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            box[axis] = numeric_limits<Point_3D::Measurement>::infinity();
+            box[axis + 3] = -numeric_limits<Point_3D::Measurement>::infinity();
+        }
+        for (Mesh_3D::const_point_iterator it = mesh.point_begin(); it != mesh.point_end(); ++it)
+        {
+            const Point_3D::Measurement p[3] = { (*it)->get_x(), (*it)->get_y(), (*it)->get_z() };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                box[axis] = min(box[axis], p[axis]);
+                box[axis + 3] = max(box[axis + 3], p[axis]);
+            }
+        }
+        bounds.insert(bounds.end(), box, box + 6);
+    }
+    
+    // true if the boxes at index1 and index2 in bounds are more than precision apart
+    static const bool boxes_apart(const vector<Point_3D::Measurement>& bounds, const int index1, 
+            const int index2, const Point_3D::Measurement precision)
+    {
+        const Point_3D::Measurement* box1(&bounds[6 * index1]);
+        const Point_3D::Measurement* box2(&bounds[6 * index2]);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (box1[axis] > box2[axis + 3] + precision || box2[axis] > box1[axis + 3] + precision)
+                return true;
+        }
+        return false;
+    }
+    
+    // add the points and facets of mesh to coords and indices
+    static void add_mesh_facets(const Mesh_3D& mesh, vector<Point_3D::Measurement>& coords, 
+            vector<int>& indices)
+    {
+        const int offset(coords.size() / 3);
+        for (Mesh_3D::const_point_iterator it = mesh.point_begin(); it != mesh.point_end(); ++it)
+        {
+            coords.push_back((*it)->get_x());
+            coords.push_back((*it)->get_y());
+            coords.push_back((*it)->get_z());
+        }
+        for (Mesh_3D::const_facet_iterator it = mesh.facet_begin(); it != mesh.facet_end(); ++it)
+        {
+            indices.push_back(it->get_p1_index() + offset);
+            indices.push_back(it->get_p2_index() + offset);
+            indices.push_back(it->get_p3_index() + offset);
+        }
+    }
+    
+    /*
+     * store the facets of mesh1 and mesh2 in result without intersecting 
+     * them.  Only used for meshes that do not touch, so the facets of the two
+     * meshes do not have to be sorted.
+     */
+    static void join_meshes(const Mesh_3D& mesh1, const Mesh_3D& mesh2, Mesh_3D& result)
+    {
+        vector<Point_3D::Measurement> coords;
+        vector<int> indices;
+        coords.reserve(3 * ((mesh1.point_end() - mesh1.point_begin()) + (mesh2.point_end() - mesh2.point_begin())));
+        indices.reserve(3 * (mesh1.size() + mesh2.size()));
+        add_mesh_facets(mesh1, coords, indices);
+        add_mesh_facets(mesh2, coords, indices);
+        Mesh_3D temp(result.get_precision(), coords, indices);
+        temp.remove_unused_points();
+        if (result.get_weld_points())
+        {
+            temp.weld(result.get_precision());
+            temp.set_weld_points(true);
+        }
+        result = move(temp);
+    }
+    
+    Intersect_Meshes_3D::Merge_Pairs::Merge_Pairs(const vector<Mesh_3D>& m, 
+            const vector<Point_3D::Measurement>& b, const Mesh_3D& r, const unsigned int threads) : 
+            meshes(m), bounds(b), result(r), merge_threads(threads) {}
+    
+    const Mesh_3D Intersect_Meshes_3D::Merge_Pairs::operator()(const size_t index) const
+    {
+        Mesh_3D pair_result(result.get_precision());
+        pair_result.set_weld_points(result.get_weld_points());
+        if (boxes_apart(bounds, 2 * index, 2 * index + 1, result.get_precision()))
+            join_meshes(meshes[2 * index], meshes[2 * index + 1], pair_result);
+        else
+            Intersect_Meshes_3D(merge_threads).merge(meshes[2 * index], meshes[2 * index + 1], pair_result);
+        return pair_result;
+    }
+    
+    void Intersect_Meshes_3D::merge_all(const vector<Mesh_3D>& meshes, Mesh_3D& result)
+    {
+        if (meshes.size() < 2)
+        {
+            // nothing to merge, but the result still uses the result settings
+            join_meshes(meshes.empty() ? Mesh_3D(result.get_precision()) : meshes.front(), 
+                    Mesh_3D(result.get_precision()), result);
+            return;
+        }
+        
+        vector<Mesh_3D> level(meshes);
+        vector<Point_3D::Measurement> bounds;
+        bounds.reserve(6 * level.size());
+        for (vector<Mesh_3D>::const_iterator it = level.begin(); it != level.end(); ++it)
+            add_mesh_bounds(*it, bounds);
+        
+        while (level.size() > 1)
+        {
+            const size_t num_pairs(level.size() / 2);
+            // a single pair uses the threads to intersect its facets instead
+            const unsigned int merge_threads(num_pairs == 1 ? num_threads : 1);
+            vector<Mesh_3D> next_level;
+            run_queries(Merge_Pairs(level, bounds, result, merge_threads), num_pairs, next_level, 
+                    num_threads, 1);
+            
+            // the merged mesh is inside the box around both meshes
+            vector<Point_3D::Measurement> next_bounds(6 * num_pairs);
+            for (size_t i = 0; i < num_pairs; ++i)
+            {
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    next_bounds[6 * i + axis] = min(bounds[12 * i + axis], bounds[12 * i + 6 + axis]);
+                    next_bounds[6 * i + 3 + axis] = max(bounds[12 * i + 3 + axis], bounds[12 * i + 9 + axis]);
+                }
+            }
+            if (level.size() % 2 != 0)
+            {
+                // the last mesh is merged in a later round
+                next_level.push_back(level.back());
+                next_bounds.insert(next_bounds.end(), bounds.end() - 6, bounds.end());
+            }
+            level.swap(next_level);
+            bounds.swap(next_bounds);
+        }
+        result = move(level.front());
+    }
 
 }
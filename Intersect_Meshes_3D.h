@@ -22,10 +22,14 @@
 
 #include <forward_list>
 #include <memory>
+#include <unordered_map>
 #include "Point_3D.h"
 #include "Facet.h"
 #include "Facet_3D.h"
 #include "Mesh_3D.h"
+#include "Facet_Tree_3D.h"
+#include "Point_Grid_3D.h"
+#include "Point_Index.h"
 
 using namespace std;
 
@@ -149,14 +153,6 @@ namespace VCAD_lib
                 I_Pt_Data(); // sets num to zero and initializes ip1 and ip2 with null constructor
             };
             
-            class Point_Find {
-            public:
-                Point_Find(const shared_ptr<Point_3D>& point, const Point_3D::Measurement prec);
-                const bool operator()(const shared_ptr<Point_3D>& other_pt);
-            private:
-                const Point_3D::Measurement precision;
-                const shared_ptr<Point_3D> pt;
-            };
         public:
             /*
              * Constructor
@@ -179,6 +175,7 @@ namespace VCAD_lib
             Facet_3D facet1;
             Facet_3D facet2;
             vector<shared_ptr<Point_3D>> generated_pts;
+            Equal_Point_Grid_3D generated_grid; // generated_pts for finding points within precision
             
             const bool matches(const shared_ptr<Point_3D>& p1, const shared_ptr<Point_3D>& p2) const;
             
@@ -305,21 +302,54 @@ namespace VCAD_lib
              */
             const Facet find_facet(const Facet_3D& facet) const;
             /*
-             * Replaces facet with new_facets
-             * returns a pointer to the first of the newly inserted facets
+             * Replaces many facets in one pass over the facet list.  
+             * new_facets has an entry for each facet: the facets to replace 
+             * it with or null to keep it.  The new facets are inserted, in 
+             * order, where the facet they replace was.  Their points are 
+             * added to the point list unless a point with the same 
+             * coordinates is already there.
              * 
              * Arguments:
-             * facet: the facet to replace
-             * new_facets: the facets to replace facet with
+             * new_facets: the replacement facets for each facet
              */
-            const_iterator replace_facet(const Facet facet, const Facets& new_facets);
+            void replace_facets(const vector<shared_ptr<Facets>>& new_facets);
         private:
             vector<shared_ptr<Point_3D>> point_list; // list of points
             vector<Facet> facet_list; // list of Facet
-            /*
-             * Checks if the point values are the same
-             */
-            const bool matches(const Point_3D& p1, const Point_3D& p2) const;
+            Point_Index<Point_3D> point_index; // point_list by exact coordinates
+            // find the facet points in point_list (see Point_Index::find_points)
+            void find_points(const Point_3D& p1, const Point_3D& p2, const Point_3D& p3, 
+                    int& p1_index, int& p2_index, int& p3_index) const
+            {
+                point_index.find_points(point_list, p1, p2, p3, p1_index, p2_index, p3_index);
+            }
+            // add a point to point_list and return its index
+            const int add_point(const shared_ptr<Point_3D>& pt) { return point_index.add_point(point_list, pt); }
+        };
+
+        /*
+         * Facets for a result mesh taken from two Facets lists.  The points 
+         * are copied once and the facets are handed to the result mesh in one
+         * step instead of being added one at a time.
+         */
+        class Result_Facets {
+        public:
+            Result_Facets(const Facets& facets1, const Facets& facets2);
+            // add a facet of facets1
+            void push_back_facet1(const Facet& facet);
+            // add a facet of facets2
+            void push_back_facet2(const Facet& facet);
+            // add a facet of facets2 with the unit normal vector inverted
+            void push_back_inverted_facet2(const Facet& facet);
+            /*
+             * replace the facets of mesh with the result facets.  Points with 
+             * the same coordinates are merged and unused points are removed.
+             */
+            void move_to(Mesh_3D& mesh) const;
+        private:
+            vector<Point_3D::Measurement> coords;
+            vector<int> indices;
+            int facets2_offset; // index of the first facets2 point in coords
         };
 
 	/*
@@ -663,19 +693,19 @@ namespace VCAD_lib
         /*
          * Sort intersected facets to know which facets are on the surface or 
          * inside the other mesh.
+         * 
+         * A facet whose box does not overlap a facet box of the other mesh 
+         * cannot cross the other mesh, so connected facets that do not 
+         * overlap the other mesh are all on the same side of it.  Each group 
+         * of them is located by the first facet of the group.  The facets 
+         * that overlap the other mesh are located one at a time.  A facet is
+         * located by its inside point: on the surface if the point is on a 
+         * facet of the other mesh, otherwise inside or outside by the closest
+         * facet of the other mesh along a ray (see mesh_contains_point).
          */
         class Facet_Sorter {
         public:
-            typedef vector<Facet>::const_iterator const_iterator;
-            
-            const_iterator f1_surface_begin() { return f1_on_surface_f2.begin(); }
-            const_iterator f1_surface_end() { return f1_on_surface_f2.end(); }
-            const_iterator f1_inside_begin() { return f1_inside_f2.begin(); }
-            const_iterator f1_inside_end() { return f1_inside_f2.end(); }
-            const_iterator f2_surface_begin() { return f2_on_surface_f1.begin(); }
-            const_iterator f2_surface_end() { return f2_on_surface_f1.end(); }
-            const_iterator f2_inside_begin() { return f2_inside_f1.begin(); }
-            const_iterator f2_inside_end() { return f2_inside_f1.end(); }
+            enum Facet_Location { outside_mesh, inside_mesh, on_mesh_surface };
             
             Facet_Sorter(const Point_3D::Measurement& prec);
             /*
@@ -689,19 +719,78 @@ namespace VCAD_lib
              */
             void sort(const Facets& facets1, const Facets& facets2);
             void clear();
+            // location of the facets1 facet at index in relation to facets2
+            const Facet_Location f1_location(const Facets::size_type index) const { return f1_locations[index]; }
+            // location of the facets2 facet at index in relation to facets1
+            const Facet_Location f2_location(const Facets::size_type index) const { return f2_locations[index]; }
         private:
+            /*
+             * The facets of a Facets list with their precalculated facet 
+             * data and a tree of their boxes.
+             */
+            struct Sort_Facets {
+                const Facets& facets;
+                vector<Point_3D::Measurement> bounds; // box of each facet enlarged by precision
+                Facet_Tree_3D tree;
+                vector<Fast_Facet_3D> fast_facets;
+                Sort_Facets(const Facets& f, const Point_3D::Measurement precision);
+                const Point_3D& point(const Facets::size_type index, const int pt) const;
+                static const vector<Point_3D::Measurement> facet_bounds(const Facets& f, 
+                        const Point_3D::Measurement precision);
+            };
+            
+            /*
+             * Finds the closest facet hit by a ray.  Used with 
+             * Facet_Tree_3D::closest_hit.
+             */
+            class Closest_Hit {
+            public:
+                Closest_Hit(const Sort_Facets& f, const Point_3D& o, const Vector_3D& v, 
+                        const Point_3D::Measurement prec);
+                const Point_3D::Measurement operator()(const int index);
+                const int get_facet() const { return facet; }
+                const bool get_on_side() const { return on_side; }
+            private:
+                const Sort_Facets& sort_facets;
+                const Point_3D& origin;
+                const Vector_3D& direction;
+                const Point_3D::Measurement precision;
+                int facet;
+                bool on_side;
+                Point_3D::Measurement closest;
+            };
+            
             Point_3D::Measurement precision;
-            vector<Facet> f1_on_surface_f2;
-            vector<Facet> f1_inside_f2;
-            vector<Facet> f2_on_surface_f1;
-            vector<Facet> f2_inside_f1;
+            vector<Facet_Location> f1_locations;
+            vector<Facet_Location> f2_locations;
+            
+            /*
+             * Locate all the facets of sort_facets in relation to other.
+             * Facets already set to on_mesh_surface in locations are skipped.
+             * surface_facets is set to the index of the other facet containing
+             * the inside point of facets on the surface or -1.
+             */
+            void locate_facets(const Sort_Facets& sort_facets, const Sort_Facets& other, 
+                    vector<Facet_Location>& locations, vector<int>& surface_facets) const;
+            /*
+             * Locate a point in relation to other.  If the point is on the 
+             * surface, surface_facet is set to the first facet of other that 
+             * contains the point.
+             */
+            const Facet_Location locate_point(const Point_3D& pt, const Sort_Facets& other, 
+                    int& surface_facet) const;
         };
     public:
         /*
-         * Constructor.  Does not perform any actions because class does not 
-         * contain any objects to initialize.
+         * Constructor.  Intersects the facets on one thread.
          */
         Intersect_Meshes_3D();
+        /*
+         * Constructor.  Intersects the facets on num_threads threads (0 uses 
+         * the number of hardware threads).  The result is the same for any 
+         * number of threads.
+         */
+        explicit Intersect_Meshes_3D(const unsigned int threads);
         /*
          * Intersect mesh1 into mesh2.  returns true if new facets were generated
          * because of the intersection.  mesh1_result and mesh2_result are only
@@ -741,7 +830,76 @@ namespace VCAD_lib
          * result: the combined mesh1 and mesh2
          */
         void merge(const Mesh_3D& mesh1, const Mesh_3D& mesh2, Mesh_3D& result);
+        /*
+         * merge all of the meshes together and store in result.  The meshes 
+         * are merged in pairs, then the pair results are merged in pairs and 
+         * so on, so each mesh is only merged about log2(meshes.size()) times.
+         * The pairs of a round are merged on num_threads threads.  A pair 
+         * whose boxes do not overlap is joined without intersecting it.  
+         * result precision and weld points setting are used for the result.
+         * 
+         * Arguments:
+         * meshes: the meshes to combine
+         * result: the combined meshes (no facets if meshes is empty)
+         * 
+         * exception safety: strong guarantee
+         */
+        void merge_all(const vector<Mesh_3D>& meshes, Mesh_3D& result);
     private:
+        /*
+         * Intersects a facets2 facet with the facets1 facets for 
+         * intersect_facets.  Used with run_queries.  Each facets2 facet uses 
+         * its own I_Pt_Locator, so the result does not depend on which thread
+         * finds it.  The intersect points generated for different facets2 
+         * facets are shared afterwards by intersect_facets.
+         */
+        class Intersecting_Facets {
+        public:
+            Intersecting_Facets(const vector<Facet_Builder>& builders, const Facet_Tree_3D& tree, 
+                    const vector<Facet_3D>& facets, const Point_3D::Measurement prec);
+            /*
+             * the index in f1_builders and the intersect points of each facet
+             * that intersects f2_facets[index] in index order
+             */
+            const vector<pair<int,I_Pt_List>> operator()(const size_t index) const;
+        private:
+            const vector<Facet_Builder>& f1_builders;
+            const Facet_Tree_3D& f1_tree;
+            const vector<Facet_3D>& f2_facets;
+            const Point_3D::Measurement precision;
+        };
+        
+        /*
+         * Forms the new facets of each facet builder for intersect_facets.  
+         * Used with run_queries.  Returns null if the facet was not 
+         * intersected.
+         */
+        class Form_Facets {
+        public:
+            explicit Form_Facets(vector<Facet_Builder>& b) : builders(b) {}
+            const shared_ptr<Facets> operator()(const size_t index) const;
+        private:
+            vector<Facet_Builder>& builders;
+        };
+        
+        /*
+         * Merges meshes[2 * index] and meshes[2 * index + 1] for merge_all.
+         * Used with run_queries.  bounds has the box of each mesh (min x, y, 
+         * z then max x, y, z).
+         */
+        class Merge_Pairs {
+        public:
+            Merge_Pairs(const vector<Mesh_3D>& m, const vector<Point_3D::Measurement>& b, 
+                    const Mesh_3D& r, const unsigned int threads);
+            const Mesh_3D operator()(const size_t index) const;
+        private:
+            const vector<Mesh_3D>& meshes;
+            const vector<Point_3D::Measurement>& bounds;
+            const Mesh_3D& result; // has the precision and weld points setting to use
+            const unsigned int merge_threads;
+        };
+        
+        unsigned int num_threads;
         
         /*
          * Intersect two facets.  
@@ -752,6 +910,18 @@ namespace VCAD_lib
          * precision: the precision to perform the intersection
          */
         void intersect_facets(Facets& facets1, Facets& facets2, const Point_3D::Measurement precision);
+        /*
+         * Replace the generated intersect points (not a corner of either 
+         * facet) with the first point in shared_pts that is_equal to them, 
+         * adding them if there is none.
+         * 
+         * Arguments:
+         * intersect_pts: the intersect points of a facet pair
+         * shared_grid: the shared_pts points
+         * shared_pts: the generated points of the facet pairs shared so far
+         */
+        static void share_points(I_Pt_List& intersect_pts, Equal_Point_Grid_3D& shared_grid, 
+                vector<shared_ptr<Point_3D>>& shared_pts);
     };
 
 }
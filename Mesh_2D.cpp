@@ -20,8 +20,8 @@
 #include "Mesh_2D.h"
 #include <cfloat>
 #include <algorithm>
-#include <unordered_map>
 #include <utility>
+#include "Half_Edge_Mesh.h"
 #include "Point_3D.h"
 #include "Mesh_3D.h"
 
@@ -144,6 +144,24 @@ namespace VCAD_lib
         return *this;
     }
     
+    Mesh_2D::Mesh_2D(Mesh_2D&& orig) noexcept : precision(orig.precision), point_list(), facet_list()
+    {
+        this->swap(orig);
+    }
+    
+    Mesh_2D& Mesh_2D::operator=(Mesh_2D&& other) noexcept
+    {
+        this->swap(other);
+        return *this;
+    }
+    
+    void Mesh_2D::swap(Mesh_2D& other) noexcept
+    {
+        std::swap(precision, other.precision);
+        point_list.swap(other.point_list);
+        facet_list.swap(other.facet_list);
+    }
+    
     Mesh_2D::const_iterator Mesh_2D::begin() const 
     {
         return const_iterator(point_list.begin(), facet_list.begin(), facet_list.end(), facet_list.begin()); 
@@ -522,73 +540,7 @@ namespace VCAD_lib
         }
         
         // determine outside line segments
-        struct Facet_Side {
-            int point1;
-            int point2;
-            Facet_Side(const int pt1, const int pt2) : point1(pt1), point2(pt2) {}
-            const bool operator==(const Facet_Side& side) const
-            {
-                return (point1 == side.point1 || point1 == side.point2) && 
-                        (point2 == side.point2 || point2 == side.point1);
-            }
-        };
-
-        struct Facet_Side_Hasher {
-            const int operator()(const Facet_Side& side) const
-            {
-                return side.point1 ^ side.point2;
-            }
-        };
-        
-        unordered_map<Facet_Side,int,Facet_Side_Hasher> facet_sides;
-        
-        for (Mesh_2D::const_facet_iterator it = mesh_2d.facet_begin(); it != mesh_2d.facet_end(); ++it)
-        {
-            // p1p2
-            Facet_Side side(it->get_p1_index(), it->get_p2_index());
-            unordered_map<Facet_Side,int,Facet_Side_Hasher>::iterator side_it = facet_sides.find(side);
-            if (side_it == facet_sides.end()) 
-            {
-                facet_sides.insert(pair<Facet_Side,int>(side, 1));
-            }
-            else
-            {
-                side_it->second = side_it->second + 1;
-            }
-            
-            // p1p3
-            side = Facet_Side(it->get_p1_index(), it->get_p3_index());
-            side_it = facet_sides.find(side);
-            if (side_it == facet_sides.end()) 
-            {
-                facet_sides.insert(pair<Facet_Side,int>(side, 1));
-            }
-            else
-            {
-                side_it->second = side_it->second + 1;
-            }
-            
-            // p2p3
-            side = Facet_Side(it->get_p2_index(), it->get_p3_index());
-            side_it = facet_sides.find(side);
-            if (side_it == facet_sides.end()) 
-            {
-                facet_sides.insert(pair<Facet_Side,int>(side, 1));
-            }
-            else
-            {
-                side_it->second = side_it->second + 1;
-            }
-        }
-        
-        // find outside segments
-        vector<Facet_Side> outside_segments;
-        for (unordered_map<Facet_Side,int,Facet_Side_Hasher>::const_iterator it = facet_sides.begin(); it != facet_sides.end(); ++it)
-        {
-            if (it->second == 1)
-                outside_segments.push_back(it->first);
-        }
-        facet_sides.clear();
+        const Half_Edge_Mesh topology(mesh_2d);
         
         Point_2D::Measurement lower_z = center ? -height / 2 : 0;
         Point_2D::Measurement upper_z = center ? height / 2 : height;
@@ -613,12 +565,15 @@ namespace VCAD_lib
         }
         
         // generate side facets
-        for (vector<Facet_Side>::const_iterator it = outside_segments.begin(); it != outside_segments.end(); ++it)
+        for (int h = 0; h < static_cast<int>(topology.half_edge_size()); ++h)
         {
+            if (!topology.is_boundary(h))
+                continue;
+            
             Mesh_2D::const_point_iterator p1_it = mesh_2d.point_begin();
             Mesh_2D::const_point_iterator p2_it = mesh_2d.point_begin();
-            advance(p1_it, it->point1);
-            advance(p2_it, it->point2);
+            advance(p1_it, topology.point1(h));
+            advance(p2_it, topology.point2(h));
             
             mesh.push_back(Facet_3D(shared_ptr<Point_3D>(new Point_3D((*p1_it)->get_x(), (*p1_it)->get_y(), lower_z)), 
                     shared_ptr<Point_3D>(new Point_3D((*p2_it)->get_x(), (*p2_it)->get_y(), upper_z)), 
@@ -83,6 +83,13 @@ namespace VCAD_lib
         Mesh_2D(const Mesh_2D& orig);
         // exception safety: strong guarantee
         Mesh_2D& operator=(const Mesh_2D&);
+        // orig is left as an empty mesh with the same precision
+        // exception safety: no throw
+        Mesh_2D(Mesh_2D&& orig) noexcept;
+        // exception safety: no throw
+        Mesh_2D& operator=(Mesh_2D&& other) noexcept;
+        // exception safety: no throw
+        void swap(Mesh_2D& other) noexcept;
         // exception safety: no throw
         Measurement get_precision() const { return precision; }
         // iterators
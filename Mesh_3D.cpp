@@ -20,6 +20,11 @@
 #include "Mesh_3D.h"
 #include <cfloat>
 #include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+#include "Facet_Tree_3D.h"
+#include "Parallel_Queries.h"
 #include "Point_2D.h"
 #include "Mesh_2D.h"
 
@@ -34,7 +39,16 @@ namespace VCAD_lib
                 (facet.get_p1_index() == facet_to_find.get_p3_index() && facet.get_p2_index() == facet_to_find.get_p1_index() && facet.get_p3_index() == facet_to_find.get_p2_index());
     }
     
-    Mesh_3D::const_iterator::const_iterator(const vector<shared_ptr<Point_3D>>::const_iterator point_it_begin, 
+    Mesh_3D::Point_Match::Point_Match(const vector<shared_ptr<const Point_3D>>& points, 
+            const Point_3D& point, const Point_3D::Measurement prec) : 
+            point_list(points), pt(point), precision(prec) {}
+    
+    const bool Mesh_3D::Point_Match::operator()(const int index) const
+    {
+        return is_equal(*point_list[index], pt, precision);
+    }
+    
+    Mesh_3D::const_iterator::const_iterator(const vector<shared_ptr<const Point_3D>>::const_iterator point_it_begin, 
             const vector<Facet>::const_iterator facet_it_begin, const vector<Facet>::const_iterator facet_it_end, 
             const vector<Facet>::const_iterator position)
             : point_list_begin(point_it_begin), facets_begin(facet_it_begin), 
@@ -49,10 +63,18 @@ namespace VCAD_lib
         if (current_facet == facets_end)
             throw runtime_error("iterator is at end of mesh");
         else // update facet
-            facet = Facet_3D(
-                    *(point_list_begin + current_facet->get_p1_index()), 
-                    *(point_list_begin + current_facet->get_p2_index()), 
-                    *(point_list_begin + current_facet->get_p3_index()));
+        {
+            // the facet has its own copy of the points in one block, so 
+            // changing them does not change the mesh or its copies
+            shared_ptr<Point_Block> points(new Point_Block());
+            points->reserve(3);
+            points->push_back(**(point_list_begin + current_facet->get_p1_index()));
+            points->push_back(**(point_list_begin + current_facet->get_p2_index()));
+            points->push_back(**(point_list_begin + current_facet->get_p3_index()));
+            facet = Facet_3D(shared_ptr<Point_3D>(points, &(*points)[0]), 
+                    shared_ptr<Point_3D>(points, &(*points)[1]), 
+                    shared_ptr<Point_3D>(points, &(*points)[2]));
+        }
     }
     
     bool Mesh_3D::const_iterator::operator==(const const_iterator& other_it) const
@@ -114,229 +136,608 @@ namespace VCAD_lib
         return &facet;
     }
     
-    Mesh_3D::Mesh_3D() : precision(DBL_EPSILON * 21), point_list(), facet_list() {}
+    const shared_ptr<Mesh_3D::Mesh_Data> Mesh_3D::empty_data(new Mesh_3D::Mesh_Data());
+    
+    Mesh_3D::Mesh_3D() : precision(DBL_EPSILON * 21), data(new Mesh_Data()), 
+            point_index(), point_index_valid(true), weld_points(false), 
+            weld_grid(DBL_EPSILON * 21), weld_scale(1), 
+            facet_planes(), facet_planes_valid(false), facet_tree(), 
+            facet_tree_valid(false), cache_mutex() {}
     
-    Mesh_3D::Mesh_3D(const Measurement prec) : precision(prec), point_list(), facet_list() {}
+    Mesh_3D::Mesh_3D(const Measurement prec) : precision(prec), data(new Mesh_Data()), 
+            point_index(), point_index_valid(true), weld_points(false), 
+            weld_grid(prec > 0 ? prec : 1), weld_scale(1), 
+            facet_planes(), facet_planes_valid(false), facet_tree(), 
+            facet_tree_valid(false), cache_mutex()
+    {
+        if (prec <= 0)
+            throw invalid_argument("precision must be greater than zero");
+    }
 
-    Mesh_3D::Mesh_3D(const Mesh_3D& orig) : precision(orig.precision), point_list(), facet_list(orig.facet_list)
+    Mesh_3D::Mesh_3D(const Measurement prec, const vector<Measurement>& coords, 
+            const vector<int>& indices) : precision(prec), data(new Mesh_Data()), 
+            point_index(), point_index_valid(true), weld_points(false), 
+            weld_grid(prec > 0 ? prec : 1), weld_scale(1), 
+            facet_planes(), facet_planes_valid(false), facet_tree(), 
+            facet_tree_valid(false), cache_mutex()
     {
+        if (prec <= 0)
+            throw invalid_argument("precision must be greater than zero");
+        append(coords, indices);
+    }
+    
+    // the copy shares data with orig.  The point index is rebuilt when needed
+    Mesh_3D::Mesh_3D(const Mesh_3D& orig) : precision(orig.precision), data(orig.data), 
+            point_index(), point_index_valid(false), weld_points(orig.weld_points), 
+            weld_grid(orig.weld_grid.get_cell_size()), weld_scale(orig.weld_scale), 
+            facet_planes(), facet_planes_valid(false), facet_tree(), 
+            facet_tree_valid(false), cache_mutex() {}
+    
+    Mesh_3D& Mesh_3D::operator=(const Mesh_3D& other)
+    {
+        if (this == &other)
+            return *this;
+        
+        Point_Grid_3D new_weld_grid(other.weld_grid.get_cell_size());
         
-        for (vector<shared_ptr<Point_3D>>::const_iterator iter = orig.point_list.begin(); iter < orig.point_list.end(); ++iter)
+        precision = other.precision;
+        data = other.data;
+        point_index.clear();
+        point_index_valid = false;
+        weld_points = other.weld_points;
+        std::swap(weld_grid, new_weld_grid);
+        weld_scale = other.weld_scale;
+        clear_facet_caches();
+        return *this;
+    }
+    
+    // orig is left with the shared empty data and rebuilds its caches when needed
+    Mesh_3D::Mesh_3D(Mesh_3D&& orig) noexcept : precision(orig.precision), 
+            data(std::move(orig.data)), point_index(std::move(orig.point_index)), 
+            point_index_valid(orig.point_index_valid), weld_points(orig.weld_points), 
+            weld_grid(std::move(orig.weld_grid)), weld_scale(orig.weld_scale), 
+            facet_planes(std::move(orig.facet_planes)), facet_planes_valid(orig.facet_planes_valid.load()), 
+            facet_tree(std::move(orig.facet_tree)), facet_tree_valid(orig.facet_tree_valid.load()), 
+            cache_mutex()
+    {
+        orig.data = empty_data;
+        orig.point_index.clear();
+        orig.point_index_valid = false;
+        orig.facet_planes.clear();
+        orig.clear_facet_caches();
+    }
+    
+    Mesh_3D& Mesh_3D::operator=(Mesh_3D&& other) noexcept
+    {
+        this->swap(other);
+        return *this;
+    }
+    
+    void Mesh_3D::swap(Mesh_3D& other) noexcept
+    {
+        std::swap(precision, other.precision);
+        data.swap(other.data);
+        point_index.swap(other.point_index);
+        std::swap(point_index_valid, other.point_index_valid);
+        std::swap(weld_points, other.weld_points);
+        std::swap(weld_grid, other.weld_grid);
+        std::swap(weld_scale, other.weld_scale);
+        facet_planes.swap(other.facet_planes);
+        const bool planes_valid(facet_planes_valid);
+        facet_planes_valid = other.facet_planes_valid.load();
+        other.facet_planes_valid = planes_valid;
+        facet_tree.swap(other.facet_tree);
+        const bool tree_valid(facet_tree_valid);
+        facet_tree_valid = other.facet_tree_valid.load();
+        other.facet_tree_valid = tree_valid;
+    }
+    
+    void Mesh_3D::detach()
+    {
+        if (data.use_count() == 1)
+            return;
+        
+        shared_ptr<Mesh_Data> new_data(new Mesh_Data());
+        copy_points(data->point_list, new_data->point_list, new_data->point_blocks);
+        new_data->facet_list = data->facet_list;
+        data = new_data;
+    }
+    
+    void Mesh_3D::copy_points(const vector<shared_ptr<const Point_3D>>& from_list, 
+            vector<shared_ptr<const Point_3D>>& to_list, vector<shared_ptr<Point_Block>>& to_blocks)
+    {
+        // copy all of the points into one block
+        shared_ptr<Point_Block> block(new Point_Block());
+        block->reserve(from_list.size());
+        to_list.reserve(from_list.size());
+        for (vector<shared_ptr<const Point_3D>>::const_iterator iter = from_list.begin(); iter != from_list.end(); ++iter)
         {
-            shared_ptr<Point_3D> ptr(new Point_3D(**iter));
-            point_list.push_back(ptr);
+            block->push_back(**iter);
+            to_list.push_back(shared_ptr<const Point_3D>(block, &block->back()));
         }
+        if (!block->empty())
+            to_blocks.push_back(block);
     }
     
-    Mesh_3D& Mesh_3D::operator=(const Mesh_3D& other)
+    const shared_ptr<const Point_3D> Mesh_3D::new_point(const Point_3D& pt)
     {
-        precision = other.precision;
-        facet_list = other.facet_list;
-        point_list.clear();
-        for (vector<shared_ptr<Point_3D>>::const_iterator iter = other.point_list.begin(); iter < other.point_list.end(); ++iter)
+        if (data->point_blocks.empty() || data->point_blocks.back()->size() == data->point_blocks.back()->capacity())
         {
-            shared_ptr<Point_3D> ptr(new Point_3D(**iter));
-            point_list.push_back(ptr);
+            shared_ptr<Point_Block> block(new Point_Block());
+            block->reserve(point_block_size);
+            data->point_blocks.push_back(block);
         }
-        return *this;
+        
+        // the block was reserved, so adding a point does not move the other points
+        Point_Block& block(*data->point_blocks.back());
+        block.push_back(pt);
+        return shared_ptr<const Point_3D>(data->point_blocks.back(), &block.back());
     }
     
     Mesh_3D::const_iterator Mesh_3D::begin() const 
     {
-        return const_iterator(point_list.begin(), facet_list.begin(), facet_list.end(), facet_list.begin()); 
+        return const_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), data->facet_list.begin()); 
     }
     
     Mesh_3D::const_iterator Mesh_3D::cbegin() const
     {
-        return const_iterator(point_list.begin(), facet_list.begin(), facet_list.end(), facet_list.begin()); 
+        return const_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), data->facet_list.begin()); 
     }
     
     Mesh_3D::const_iterator Mesh_3D::end() const
     {
-        return const_iterator(point_list.begin(), facet_list.begin(), facet_list.end(), facet_list.end()); 
+        return const_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), data->facet_list.end()); 
     }
     
     Mesh_3D::const_iterator Mesh_3D::cend() const
     {
-        return const_iterator(point_list.begin(), facet_list.begin(), facet_list.end(), facet_list.end()); 
+        return const_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), data->facet_list.end()); 
     }
     
-    void Mesh_3D::push_back(const Facet_3D& facet)
+    Mesh_3D::const_view_iterator Mesh_3D::view_begin() const
     {
-        // find points if mesh already contains them
-        int p1_index(-1);
-        int p2_index(-1);
-        int p3_index(-1);
-        int index(0);
-        for (vector<shared_ptr<Point_3D>>::const_iterator point_it = point_list.begin(); point_it != point_list.end(); ++point_it)
+        return const_view_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.begin(), 
+                facet_planes_valid.load(memory_order_acquire) ? facet_planes.data() : nullptr);
+    }
+    
+    Mesh_3D::const_view_iterator Mesh_3D::view_end() const
+    {
+        return const_view_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), 
+                facet_planes_valid.load(memory_order_acquire) ? facet_planes.data() : nullptr);
+    }
+    
+    void Mesh_3D::cache_facet_planes() const
+    {
+        if (facet_planes_valid.load(memory_order_acquire))
+            return;
+        
+        lock_guard<mutex> lock(cache_mutex);
+        if (facet_planes_valid.load(memory_order_relaxed))
+            return;
+        
+        vector<Facet_Plane> planes;
+        planes.reserve(data->facet_list.size());
+        for (vector<Facet>::const_iterator it = data->facet_list.begin(); it != data->facet_list.end(); ++it)
         {
-            // test p1
-            if ((*point_it)->get_x() == facet.get_point1()->get_x() && (*point_it)->get_y() == facet.get_point1()->get_y() && (*point_it)->get_z() == facet.get_point1()->get_z())
-                p1_index = index;
-            else if ((*point_it)->get_x() == facet.get_point2()->get_x() && (*point_it)->get_y() == facet.get_point2()->get_y() && (*point_it)->get_z() == facet.get_point2()->get_z())
-                p2_index = index;
-            else if ((*point_it)->get_x() == facet.get_point3()->get_x() && (*point_it)->get_y() == facet.get_point3()->get_y() && (*point_it)->get_z() == facet.get_point3()->get_z())
-                p3_index = index;
-            ++index;
+            const Point_3D& p1(*data->point_list[it->get_p1_index()]);
+            Vector_3D unv(cross_product(Vector_3D(p1, *data->point_list[it->get_p2_index()]), 
+                    Vector_3D(p1, *data->point_list[it->get_p3_index()])));
+            if (unv.length() == 0) // points do not form a triangle
+            {
+                planes.push_back(Facet_Plane(unv, 0, false));
+                continue;
+            }
+            unv.normalize();
+            planes.push_back(Facet_Plane(unv, unv.get_x() * p1.get_x() + unv.get_y() * p1.get_y() + 
+                    unv.get_z() * p1.get_z(), true));
         }
+        facet_planes.swap(planes);
+        facet_planes_valid.store(true, memory_order_release);
+    }
+    
+    const Mesh_3D::Facet_Plane& Mesh_3D::get_facet_plane(const size_type index) const
+    {
+        if (index >= data->facet_list.size())
+            throw out_of_range("facet index out of range");
+        cache_facet_planes();
+        return facet_planes[index];
+    }
+    
+    const Facet_Tree_3D& Mesh_3D::get_facet_tree() const
+    {
+        if (!facet_tree_valid.load(memory_order_acquire))
+        {
+            lock_guard<mutex> lock(cache_mutex);
+            if (!facet_tree_valid.load(memory_order_relaxed))
+            {
+                facet_tree.reset(new Facet_Tree_3D(*this));
+                facet_tree_valid.store(true, memory_order_release);
+            }
+        }
+        return *facet_tree;
+    }
+    
+    void Mesh_3D::update_point_index()
+    {
+        if (point_index_valid)
+            return;
+        
+        point_index.clear();
+        point_index.reserve(data->point_list.size());
+        int index(0);
+        for (vector<shared_ptr<const Point_3D>>::const_iterator point_it = data->point_list.begin(); point_it != data->point_list.end(); ++point_it)
+            point_index.insert(pair<Point_Key,int>(Point_Key(**point_it), index++)); // keeps the first index of duplicate points
         
-        // add points if not found
-        if (p1_index == -1)
+        if (weld_points)
         {
-            point_list.push_back(shared_ptr<Point_3D>(new Point_3D(*facet.get_point1())));
-            p1_index = index;
-            ++index;
+            weld_scale = 1;
+            for (vector<shared_ptr<const Point_3D>>::const_iterator point_it = data->point_list.begin(); point_it != data->point_list.end(); ++point_it)
+                weld_scale = Equal_Point_Grid_3D::cell_scale(**point_it, weld_scale);
+            build_weld_grid();
         }
-        if (p2_index == -1)
+        point_index_valid = true;
+    }
+    
+    void Mesh_3D::build_weld_grid()
+    {
+        weld_grid.clear(precision * weld_scale);
+        weld_grid.reserve(data->point_list.size());
+        int index(0);
+        for (vector<shared_ptr<const Point_3D>>::const_iterator point_it = data->point_list.begin(); point_it != data->point_list.end(); ++point_it)
+            weld_grid.insert(**point_it, index++);
+    }
+    
+    const int Mesh_3D::find_or_add_point(const Point_3D& pt)
+    {
+        pair<unordered_map<Point_Key,int,Point_Key_Hasher>::iterator,bool> result = 
+                point_index.insert(pair<Point_Key,int>(Point_Key(pt), data->point_list.size()));
+        if (result.second) // point was not found, so add it
         {
-            point_list.push_back(shared_ptr<Point_3D>(new Point_3D(*facet.get_point2())));
-            p2_index = index;
-            ++index;
+            try
+            {
+                data->point_list.push_back(new_point(pt));
+            }
+            catch (...)
+            {
+                point_index.erase(result.first);
+                throw;
+            }
         }
-        if (p3_index == -1)
+        return result.first->second;
+    }
+    
+    const int Mesh_3D::find_weld_point(const Point_3D& pt)
+    {
+        // exact match
+        unordered_map<Point_Key,int,Point_Key_Hasher>::const_iterator exact_it = point_index.find(Point_Key(pt));
+        if (exact_it != point_index.end())
+            return exact_it->second;
+        
+        // grow the grid cells if the point is larger than the current cell size allows for
+        Measurement scale(Equal_Point_Grid_3D::cell_scale(pt, weld_scale));
+        if (scale != weld_scale)
         {
-            point_list.push_back(shared_ptr<Point_3D>(new Point_3D(*facet.get_point3())));
-            p3_index = index;
-            ++index;
+            weld_scale = scale;
+            build_weld_grid();
         }
         
-        // add facet
-        facet_list.push_back(Facet(p1_index, p2_index, p3_index));
+        // point within precision
+        return weld_grid.find_if(pt, Point_Match(data->point_list, pt, precision));
     }
     
-    void Mesh_3D::clear()
+    const int Mesh_3D::add_weld_point(const Point_3D& pt)
     {
-        facet_list.clear();
-        point_list.clear();
+        const int index(find_or_add_point(pt));
+        weld_grid.insert(pt, index);
+        return index;
     }
     
-    Mesh_3D::const_iterator Mesh_3D::erase(const_iterator it)
+    void Mesh_3D::push_back(const Facet_3D& facet)
     {
-        // first find point indices
-        int p1_index(-1);
-        vector<shared_ptr<Point_3D>>::const_iterator p1_it(point_list.end());
-        int p2_index(-1);
-        vector<shared_ptr<Point_3D>>::const_iterator p2_it(point_list.end());
-        int p3_index(-1);
-        vector<shared_ptr<Point_3D>>::const_iterator p3_it(point_list.end());
-        int index(0);
-        for (vector<shared_ptr<Point_3D>>::const_iterator point_it = point_list.begin(); point_it != point_list.end(); ++point_it)
+        detach();
+        update_point_index();
+        clear_facet_caches();
+        
+        if (weld_points)
         {
-            // test p1
-            if ((*point_it)->get_x() == it->get_point1()->get_x() && (*point_it)->get_y() == it->get_point1()->get_y() && (*point_it)->get_z() == it->get_point1()->get_z())
-            {
-                p1_index = index;
-                p1_it = point_it;
-            }
-            else if ((*point_it)->get_x() == it->get_point2()->get_x() && (*point_it)->get_y() == it->get_point2()->get_y() && (*point_it)->get_z() == it->get_point2()->get_z())
+            const Point_3D& p1(*facet.get_point1());
+            const Point_3D& p2(*facet.get_point2());
+            const Point_3D& p3(*facet.get_point3());
+            int p1_index(find_weld_point(p1));
+            int p2_index(find_weld_point(p2));
+            int p3_index(find_weld_point(p3));
+            
+            // facet collapsed to a line or point.  Points that are not in the 
+            // mesh yet would weld to the facet points before them.
+            if ((p1_index != -1 && (p1_index == p2_index || p1_index == p3_index)) || 
+                    (p2_index != -1 && p2_index == p3_index) || 
+                    (p1_index == -1 && p2_index == -1 && is_equal(p1, p2, precision)) || 
+                    (p1_index == -1 && p3_index == -1 && is_equal(p1, p3, precision)) || 
+                    (p2_index == -1 && p3_index == -1 && is_equal(p2, p3, precision)))
+                return;
+            
+            // only add the points of a facet that is added
+            if (p1_index == -1)
+                p1_index = add_weld_point(p1);
+            if (p2_index == -1)
+                p2_index = add_weld_point(p2);
+            if (p3_index == -1)
+                p3_index = add_weld_point(p3);
+            data->facet_list.push_back(Facet(p1_index, p2_index, p3_index));
+            return;
+        }
+        
+        // find points if mesh already contains them, add points if not found
+        int p1_index(find_or_add_point(*facet.get_point1()));
+        int p2_index(find_or_add_point(*facet.get_point2()));
+        int p3_index(find_or_add_point(*facet.get_point3()));
+        
+        // add facet
+        data->facet_list.push_back(Facet(p1_index, p2_index, p3_index));
+    }
+    
+    void Mesh_3D::reserve(const size_type num_points, const size_type num_facets)
+    {
+        detach();
+        data->facet_list.reserve(num_facets);
+        data->point_list.reserve(num_points);
+        if (num_points > data->point_list.size())
+        {
+            size_type needed(num_points - data->point_list.size());
+            if (data->point_blocks.empty() || data->point_blocks.back()->capacity() - data->point_blocks.back()->size() < needed)
             {
-                p2_index = index;
-                p2_it = point_it;
+                shared_ptr<Point_Block> block(new Point_Block());
+                block->reserve(needed);
+                data->point_blocks.push_back(block);
             }
-            else if ((*point_it)->get_x() == it->get_point3()->get_x() && (*point_it)->get_y() == it->get_point3()->get_y() && (*point_it)->get_z() == it->get_point3()->get_z())
+        }
+    }
+    
+    void Mesh_3D::append(const vector<Measurement>& coords, const vector<int>& indices)
+    {
+        if (coords.size() % 3 != 0)
+            throw invalid_argument("coords size must be a multiple of three");
+        if (indices.size() % 3 != 0)
+            throw invalid_argument("indices size must be a multiple of three");
+        
+        const int first_index(data->point_list.size());
+        const int num_points(coords.size() / 3);
+        for (vector<int>::const_iterator it = indices.begin(); it != indices.end(); it += 3)
+        {
+            if (*it < 0 || *it >= num_points || *(it + 1) < 0 || *(it + 1) >= num_points || 
+                    *(it + 2) < 0 || *(it + 2) >= num_points)
+                throw invalid_argument("facet point index is out of range");
+            if (*it == *(it + 1) || *it == *(it + 2) || *(it + 1) == *(it + 2))
+                throw invalid_argument("facet has the same point more than once");
+        }
+        
+        detach();
+        const size_type orig_num_points(data->point_list.size());
+        const size_type orig_num_facets(data->facet_list.size());
+        try
+        {
+            reserve(data->point_list.size() + num_points, data->facet_list.size() + indices.size() / 3);
+            for (vector<Measurement>::const_iterator it = coords.begin(); it != coords.end(); it += 3)
+                data->point_list.push_back(new_point(Point_3D(*it, *(it + 1), *(it + 2))));
+            for (vector<int>::const_iterator it = indices.begin(); it != indices.end(); it += 3)
+                data->facet_list.push_back(Facet(first_index + *it, first_index + *(it + 1), first_index + *(it + 2)));
+        }
+        catch (...)
+        {
+            data->point_list.resize(orig_num_points, shared_ptr<const Point_3D>());
+            data->facet_list.resize(orig_num_facets, Facet(0, 0, 0));
+            throw;
+        }
+        
+        if (num_points > 0)
+        {
+            point_index_valid = false;
+            clear_facet_caches();
+        }
+    }
+    
+    void Mesh_3D::set_weld_points(const bool weld)
+    {
+        if (weld == weld_points)
+            return;
+        weld_points = weld;
+        if (weld_points)
+            point_index_valid = false; // build weld_grid on next push_back
+        else
+            weld_grid.clear();
+    }
+    
+    Mesh_3D& Mesh_3D::weld(const Measurement tolerance)
+    {
+        if (!(tolerance > 0))
+            throw invalid_argument("tolerance must be greater than zero");
+        
+        detach(); // the welded mesh keeps the point blocks
+        Measurement scale(1);
+        for (vector<shared_ptr<const Point_3D>>::const_iterator point_it = data->point_list.begin(); point_it != data->point_list.end(); ++point_it)
+            scale = Equal_Point_Grid_3D::cell_scale(**point_it, scale);
+        
+        // keep the first point of each group of points within tolerance
+        Point_Grid_3D grid(tolerance * scale);
+        grid.reserve(data->point_list.size());
+        vector<shared_ptr<const Point_3D>> welded_points;
+        welded_points.reserve(data->point_list.size());
+        vector<int> new_index;
+        new_index.reserve(data->point_list.size());
+        for (vector<shared_ptr<const Point_3D>>::const_iterator point_it = data->point_list.begin(); point_it != data->point_list.end(); ++point_it)
+        {
+            int index(grid.find_if(**point_it, Point_Match(welded_points, **point_it, tolerance)));
+            if (index == -1)
             {
-                p3_index = index;
-                p3_it = point_it;
+                index = welded_points.size();
+                welded_points.push_back(*point_it);
+                grid.insert(**point_it, index);
             }
-            ++index;
-        }
-        if (p1_index == -1 || p2_index == -1 || p3_index == -1)
-            throw runtime_error("unable to locate facet points");
-        // find facet in facet list
-        vector<Facet>::const_iterator facet = find_if(facet_list.begin(), facet_list.end(), Facet_Find(Facet(p1_index, p2_index, p3_index)));
-        if (facet == facet_list.end())
-            throw runtime_error("unable to locate facet");
-        
-//        // find if any other facets are using the same points
-//        bool p1_found(false);
-//        bool p2_found(false);
-//        bool p3_found(false);
-//        for (vector<Facet>::const_iterator facet_it = facet_list.begin(); facet_it != facet_list.end(); ++facet_it)
-//        {
-//            if (facet_it == facet)
-//                continue; // don't process the facet to remove
-//            if (p1_index == facet_it->get_p1_index() || p1_index == facet_it->get_p2_index() || p1_index == facet_it->get_p3_index())
-//                p1_found = true;
-//            if (p2_index == facet_it->get_p1_index() || p2_index == facet_it->get_p2_index() || p2_index == facet_it->get_p3_index())
-//                p2_found = true;
-//            if (p3_index == facet_it->get_p1_index() || p3_index == facet_it->get_p2_index() || p3_index == facet_it->get_p3_index())
-//                p3_found = true;
-//        }
-//
-//        // if the points are not used by other facets remove the points
-//        // remove the largest point indices first to not invalidate earlier point iterators
-//        if (p1_index > p2_index && p1_index > p3_index)
-//        {
-//            if (!p1_found)
-//                point_list.erase(p1_it);
-//            if (p2_index > p3_index)
-//            {
-//                if (!p2_found)
-//                    point_list.erase(p2_it);
-//                if (!p3_found)
-//                    point_list.erase(p3_it);
-//            }
-//            else
-//            {
-//                if (!p3_found)
-//                    point_list.erase(p3_it);
-//                if (!p2_found)
-//                    point_list.erase(p2_it);
-//            }
-//        }
-//        else if (p2_index > p1_index && p2_index > p3_index)
-//        {
-//            if (!p2_found)
-//                point_list.erase(p2_it);
-//            if (p1_index > p3_index)
-//            {
-//                if (!p1_found)
-//                    point_list.erase(p1_it);
-//                if (!p3_found)
-//                    point_list.erase(p3_it);
-//            }
-//            else
-//            {
-//                if (!p3_found)
-//                    point_list.erase(p3_it);
-//                if (!p1_found)
-//                    point_list.erase(p1_it);
-//            }
-//        }
-//        else
-//        {
-//            if (!p3_found)
-//                point_list.erase(p3_it);
-//            if (p1_index > p2_index)
-//            {
-//                if (!p1_found)
-//                    point_list.erase(p1_it);
-//                if (!p2_found)
-//                    point_list.erase(p2_it);
-//            }
-//            else
-//            {
-//                if (!p2_found)
-//                    point_list.erase(p2_it);
-//                if (!p1_found)
-//                    point_list.erase(p1_it);
-//            }
-//        }
+            new_index.push_back(index);
+        }
+        
+        vector<Facet> welded_facets;
+        welded_facets.reserve(data->facet_list.size());
+        for (vector<Facet>::const_iterator facet_it = data->facet_list.begin(); facet_it != data->facet_list.end(); ++facet_it)
+        {
+            int p1_index(new_index[facet_it->get_p1_index()]);
+            int p2_index(new_index[facet_it->get_p2_index()]);
+            int p3_index(new_index[facet_it->get_p3_index()]);
+            if (p1_index != p2_index && p1_index != p3_index && p2_index != p3_index)
+                welded_facets.push_back(Facet(p1_index, p2_index, p3_index));
+        }
         
-        // remove the facet
-        facet_list.erase(facet);
+        // the welded points are still in the blocks of the original points
+        shared_ptr<Mesh_Data> new_data(new Mesh_Data());
+        new_data->point_list.swap(welded_points);
+        new_data->facet_list.swap(welded_facets);
+        new_data->point_blocks = data->point_blocks;
+        data = new_data;
+        point_index_valid = false;
+        clear_facet_caches();
+        return *this;
+    }
+    
+    void Mesh_3D::clear()
+    {
+        if (data.use_count() == 1)
+        {
+            data->facet_list.clear();
+            data->point_list.clear();
+            data->point_blocks.clear();
+        }
+        else
+            data.reset(new Mesh_Data());
+        point_index.clear();
+        point_index_valid = true;
+        clear_facet_caches();
+        weld_grid.clear();
+        weld_scale = 1;
+    }
+    
+    Mesh_3D::const_iterator Mesh_3D::erase(const_iterator it)
+    {
+        if (it.current_facet == data->facet_list.end())
+            throw runtime_error("iterator is at end of mesh");
+        // the iterator holds the facet position, so no search is needed
+        const vector<Facet>::difference_type index(it.current_facet - data->facet_list.cbegin());
+        detach();
+        data->facet_list.erase(data->facet_list.begin() + index);
+        clear_facet_caches();
+        return const_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), data->facet_list.begin() + index);
     }
     
     Mesh_3D::const_iterator Mesh_3D::erase(const_iterator begin, const_iterator end)
     {
-        const_iterator it(end);
-        --it;
-        while (it != begin)
+        const vector<Facet>::difference_type index(begin.current_facet - data->facet_list.cbegin());
+        const vector<Facet>::difference_type end_index(end.current_facet - data->facet_list.cbegin());
+        detach();
+        data->facet_list.erase(data->facet_list.begin() + index, data->facet_list.begin() + end_index);
+        clear_facet_caches();
+        return const_iterator(data->point_list.begin(), data->facet_list.begin(), data->facet_list.end(), data->facet_list.begin() + index);
+    }
+    
+    void Mesh_3D::erase_unordered(const size_type index)
+    {
+        if (index >= data->facet_list.size())
+            throw out_of_range("facet index out of range");
+        detach();
+        // move the last facet into the erased facet's place
+        if (index != data->facet_list.size() - 1)
+            data->facet_list[index] = data->facet_list.back();
+        data->facet_list.pop_back();
+        clear_facet_caches();
+    }
+    
+    const Mesh_3D::size_type Mesh_3D::remove_unused_points()
+    {
+        // map old point indices to new point indices.  -1 is an unused point
+        vector<int> new_index(data->point_list.size(), -1);
+        for (vector<Facet>::const_iterator it = data->facet_list.begin(); it != data->facet_list.end(); ++it)
+        {
+            new_index[it->get_p1_index()] = 0;
+            new_index[it->get_p2_index()] = 0;
+            new_index[it->get_p3_index()] = 0;
+        }
+        int count(0);
+        for (vector<int>::iterator it = new_index.begin(); it != new_index.end(); ++it)
+        {
+            if (*it == 0)
+                *it = count++;
+        }
+        const size_type removed(data->point_list.size() - count);
+        if (removed == 0)
+            return 0;
+        
+        // copy the used points into new storage
+        vector<shared_ptr<const Point_3D>> used_points;
+        used_points.reserve(count);
+        for (size_type index = 0; index < data->point_list.size(); ++index)
+        {
+            if (new_index[index] != -1)
+                used_points.push_back(data->point_list[index]);
+        }
+        vector<shared_ptr<const Point_3D>> new_point_list;
+        vector<shared_ptr<Point_Block>> new_point_blocks;
+        copy_points(used_points, new_point_list, new_point_blocks);
+        vector<Facet> new_facet_list;
+        new_facet_list.reserve(data->facet_list.size());
+        for (vector<Facet>::const_iterator it = data->facet_list.begin(); it != data->facet_list.end(); ++it)
+            new_facet_list.push_back(Facet(new_index[it->get_p1_index()], 
+                    new_index[it->get_p2_index()], new_index[it->get_p3_index()]));
+        
+        shared_ptr<Mesh_Data> new_data(new Mesh_Data());
+        new_data->point_list.swap(new_point_list);
+        new_data->point_blocks.swap(new_point_blocks);
+        new_data->facet_list.swap(new_facet_list);
+        data = new_data;
+        point_index_valid = false;
+        clear_facet_caches();
+        return removed;
+    }
+    
+    const Mesh_3D::size_type Mesh_3D::merge_duplicate_points()
+    {
+        detach(); // the merged mesh keeps the point blocks
+        
+        // map old point indices to the index of the first point with the same coordinates
+        unordered_map<Point_Key,int,Point_Key_Hasher> first_index;
+        first_index.reserve(data->point_list.size());
+        vector<shared_ptr<const Point_3D>> merged_points;
+        merged_points.reserve(data->point_list.size());
+        vector<int> new_index;
+        new_index.reserve(data->point_list.size());
+        for (vector<shared_ptr<const Point_3D>>::const_iterator point_it = data->point_list.begin(); point_it != data->point_list.end(); ++point_it)
         {
-            this->erase(it);
-            --it;
+            pair<unordered_map<Point_Key,int,Point_Key_Hasher>::iterator,bool> result(
+                    first_index.insert(pair<Point_Key,int>(Point_Key(**point_it), merged_points.size())));
+            if (result.second)
+                merged_points.push_back(*point_it);
+            new_index.push_back(result.first->second);
         }
-        return this->erase(begin);
+        const size_type merged(data->point_list.size() - merged_points.size());
+        if (merged == 0)
+            return 0;
+        
+        vector<Facet> merged_facets;
+        merged_facets.reserve(data->facet_list.size());
+        for (vector<Facet>::const_iterator facet_it = data->facet_list.begin(); facet_it != data->facet_list.end(); ++facet_it)
+        {
+            int p1_index(new_index[facet_it->get_p1_index()]);
+            int p2_index(new_index[facet_it->get_p2_index()]);
+            int p3_index(new_index[facet_it->get_p3_index()]);
+            if (p1_index != p2_index && p1_index != p3_index && p2_index != p3_index)
+                merged_facets.push_back(Facet(p1_index, p2_index, p3_index));
+        }
+        
+        shared_ptr<Mesh_Data> new_data(new Mesh_Data());
+        new_data->point_list.swap(merged_points);
+        new_data->facet_list.swap(merged_facets);
+        new_data->point_blocks = data->point_blocks;
+        data = new_data;
+        point_index_valid = false;
+        clear_facet_caches();
+        return merged;
     }
     
 //    Mesh_3D::const_iterator Mesh_3D::insert(const_iterator loc, const Facet_3D& facet)
@@ -416,39 +817,63 @@ namespace VCAD_lib
 //        return this->insert(position, *from_facet);
 //    }
 
-    Mesh_3D& Mesh_3D::rotate(const Angle& angle)
+    Mesh_3D& Mesh_3D::transform(const Transform_3D& t)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->rotate(angle);
+        detach();
+        point_index_valid = false;
+        clear_facet_caches();
+        for (vector<shared_ptr<Point_Block>>::const_iterator block = data->point_blocks.begin(); block != data->point_blocks.end(); ++block)
+        {
+            for (Point_Block::iterator it = (*block)->begin(); it != (*block)->end(); ++it)
+                *it = t.apply(*it);
+        }
+        
+        // a transform with a negative determinant mirrors the mesh
+        const Measurement det(
+                t.get(0, 0) * (t.get(1, 1) * t.get(2, 2) - t.get(1, 2) * t.get(2, 1)) - 
+                t.get(0, 1) * (t.get(1, 0) * t.get(2, 2) - t.get(1, 2) * t.get(2, 0)) + 
+                t.get(0, 2) * (t.get(1, 0) * t.get(2, 1) - t.get(1, 1) * t.get(2, 0)));
+        if (det < 0)
+        {
+            // invert the unit normal vector of each facet by swapping p2 and p3
+            for (vector<Facet>::iterator it = data->facet_list.begin(); it != data->facet_list.end(); ++it)
+                it->invert_unv();
+        }
+        
         return *this;
     }
     
+    Mesh_3D& Mesh_3D::rotate(const Angle& angle)
+    {
+        return this->transform(Transform_3D().rotate(angle));
+    }
+    
     Mesh_3D& Mesh_3D::rotate(const Angle_Meas angle, const Vector_3D& axis)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->rotate(angle, axis);
-        return *this;
+        return this->transform(Transform_3D().rotate(angle, axis));
     }
     
     Mesh_3D& Mesh_3D::rotate(const Angle& angle, const Point_3D& origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->rotate(angle, origin);
-        return *this;
+        return this->transform(Transform_3D().rotate(angle, origin));
     }
 
     Mesh_3D& Mesh_3D::rotate(const Angle_Meas angle, const Vector_3D& axis, const Point_3D& origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->rotate(angle, axis, origin);
-        return *this;
+        return this->transform(Transform_3D().rotate(angle, axis, origin));
     }
 
     Mesh_3D& Mesh_3D::scale(const Measurement x_scalar, const Measurement y_scalar, 
             const Measurement z_scalar)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->scale(x_scalar, y_scalar, z_scalar);
+        detach();
+        point_index_valid = false;
+        clear_facet_caches();
+        for (vector<shared_ptr<Point_Block>>::const_iterator block = data->point_blocks.begin(); block != data->point_blocks.end(); ++block)
+        {
+            for (Point_Block::iterator it = (*block)->begin(); it != (*block)->end(); ++it)
+                it->scale(x_scalar, y_scalar, z_scalar);
+        }
         
         int num_neg(0);
         if (x_scalar < 0) { ++num_neg; }
@@ -457,7 +882,7 @@ namespace VCAD_lib
         if (num_neg % 2 == 1) // odd number of negative multipliers
         {
             // invert the unit normal vector of each facet by swapping p2 and p3
-            for (vector<Facet>::iterator it = facet_list.begin(); it != facet_list.end(); ++it)
+            for (vector<Facet>::iterator it = data->facet_list.begin(); it != data->facet_list.end(); ++it)
                 it->invert_unv();
         }
         
@@ -467,8 +892,14 @@ namespace VCAD_lib
     Mesh_3D& Mesh_3D::scale(const Measurement x_scalar, const Measurement y_scalar, 
             const Measurement z_scalar, const Point_3D& origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->scale(x_scalar, y_scalar, z_scalar, origin);
+        detach();
+        point_index_valid = false;
+        clear_facet_caches();
+        for (vector<shared_ptr<Point_Block>>::const_iterator block = data->point_blocks.begin(); block != data->point_blocks.end(); ++block)
+        {
+            for (Point_Block::iterator it = (*block)->begin(); it != (*block)->end(); ++it)
+                it->scale(x_scalar, y_scalar, z_scalar, origin);
+        }
         
         int num_neg(0);
         if (x_scalar < 0) { ++num_neg; }
@@ -477,7 +908,7 @@ namespace VCAD_lib
         if (num_neg % 2 == 1) // odd number of negative multipliers
         {
             // invert the unit normal vector of each facet by swapping p2 and p3
-            for (vector<Facet>::iterator it = facet_list.begin(); it != facet_list.end(); ++it)
+            for (vector<Facet>::iterator it = data->facet_list.begin(); it != data->facet_list.end(); ++it)
                 it->invert_unv();
         }
         
@@ -487,64 +918,64 @@ namespace VCAD_lib
     Mesh_3D& Mesh_3D::translate(const Measurement x_val, const Measurement y_val, 
             const Measurement z_val)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->translate(x_val, y_val, z_val);
+        detach();
+        point_index_valid = false;
+        clear_facet_caches();
+        for (vector<shared_ptr<Point_Block>>::const_iterator block = data->point_blocks.begin(); block != data->point_blocks.end(); ++block)
+        {
+            for (Point_Block::iterator it = (*block)->begin(); it != (*block)->end(); ++it)
+                it->translate(x_val, y_val, z_val);
+        }
         return *this;
     }
     
     Mesh_3D& Mesh_3D::translate(const Vector_3D& v)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->translate(v);
+        detach();
+        point_index_valid = false;
+        clear_facet_caches();
+        for (vector<shared_ptr<Point_Block>>::const_iterator block = data->point_blocks.begin(); block != data->point_blocks.end(); ++block)
+        {
+            for (Point_Block::iterator it = (*block)->begin(); it != (*block)->end(); ++it)
+                it->translate(v.get_x(), v.get_y(), v.get_z());
+        }
         return *this;
     }
     
     Mesh_3D& Mesh_3D::move_x_pxy(const Point_3D& new_origin, const Vector_3D& x_axis, 
             const Point_3D& pt_xy_plane, const Point_3D& ref_origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->move_x_pxy(new_origin, x_axis, pt_xy_plane, ref_origin);
-        return *this;
+        return this->transform(Transform_3D().move_x_pxy(new_origin, x_axis, pt_xy_plane, ref_origin));
     }
     
     Mesh_3D& Mesh_3D::move_x_pxz(const Point_3D& new_origin, const Vector_3D& x_axis, 
             const Point_3D& pt_xz_plane, const Point_3D& ref_origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->move_x_pxz(new_origin, x_axis, pt_xz_plane, ref_origin);
-        return *this;
+        return this->transform(Transform_3D().move_x_pxz(new_origin, x_axis, pt_xz_plane, ref_origin));
     }
     
     Mesh_3D& Mesh_3D::move_y_pxy(const Point_3D& new_origin, const Vector_3D& y_axis, 
             const Point_3D& pt_xy_plane, const Point_3D& ref_origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->move_y_pxy(new_origin, y_axis, pt_xy_plane, ref_origin);
-        return *this;
+        return this->transform(Transform_3D().move_y_pxy(new_origin, y_axis, pt_xy_plane, ref_origin));
     }
     
     Mesh_3D& Mesh_3D::move_y_pyz(const Point_3D& new_origin, const Vector_3D& y_axis, 
             const Point_3D& pt_yz_plane, const Point_3D& ref_origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->move_y_pyz(new_origin, y_axis, pt_yz_plane, ref_origin);
-        return *this;
+        return this->transform(Transform_3D().move_y_pyz(new_origin, y_axis, pt_yz_plane, ref_origin));
     }
     
     Mesh_3D& Mesh_3D::move_z_pxz(const Point_3D& new_origin, const Vector_3D& z_axis, 
             const Point_3D& pt_xz_plane, const Point_3D& ref_origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->move_z_pxz(new_origin, z_axis, pt_xz_plane, ref_origin);
-        return *this;
+        return this->transform(Transform_3D().move_z_pxz(new_origin, z_axis, pt_xz_plane, ref_origin));
     }
     
     Mesh_3D& Mesh_3D::move_z_pyz(const Point_3D& new_origin, const Vector_3D& z_axis, 
             const Point_3D& pt_yz_plane, const Point_3D& ref_origin)
     {
-        for (vector<shared_ptr<Point_3D>>::const_iterator it = point_list.begin(); it != point_list.end(); ++it)
-            (*it)->move_z_pyz(new_origin, z_axis, pt_yz_plane, ref_origin);
-        return *this;
+        return this->transform(Transform_3D().move_z_pyz(new_origin, z_axis, pt_yz_plane, ref_origin));
     }
     
     Mesh_3D& Mesh_3D::operator+=(const Vector_3D& v)
@@ -563,77 +994,327 @@ namespace VCAD_lib
         return this->scale(scalar, scalar, scalar);
     }
     
-    const bool mesh_contains_point(const Mesh_3D& mesh, const Point_3D& p, bool& pt_on_surface)
-    {
-        // determine if point is on or inside the mesh
-        bool outside_mesh = false;
-        for (Mesh_3D::const_iterator iter = mesh.begin(); iter != mesh.end(); ++iter)
+    /*
+     * Finds the closest facet hit by a ray from a point for mesh_contains_point.
+     * A facet only counts as hit if the ray crosses its plane inside the facet.
+     */
+    class Closest_Facet_Hit {
+    public:
+        Closest_Facet_Hit(const Mesh_3D& m, const Point_3D& o, const Vector_3D& v) : 
+                mesh(m), origin(o), direction(v), facet(-1), on_side(false), 
+                closest(numeric_limits<Point_3D::Measurement>::infinity()) {}
+        const Point_3D::Measurement operator()(const int index)
         {
-            // if point is on a facet, return true
+            const Point_3D::Measurement infinity(numeric_limits<Point_3D::Measurement>::infinity());
+            const Mesh_3D::Facet_Plane& plane(mesh.get_facet_plane(index));
+            if (!plane.valid)
+                return infinity;
+            const Point_3D::Measurement denominator(dot_product(plane.unv, direction));
+            if (denominator == 0) // ray is parallel to facet plane
+                return infinity;
+            const Point_3D::Measurement t((plane.offset - plane.unv.get_x() * origin.get_x() - 
+                    plane.unv.get_y() * origin.get_y() - plane.unv.get_z() * origin.get_z()) / denominator);
+            if (!(t > 0) || t >= closest)
+                return infinity;
+            const Point_3D i_point(origin.get_x() + t * direction.get_x(), 
+                    origin.get_y() + t * direction.get_y(), origin.get_z() + t * direction.get_z());
             bool pt_on_side(false);
-            if (iter->contains_point(p, pt_on_side, mesh.get_precision()))
+            if (!mesh.facet_view(index).contains_point(i_point, pt_on_side, mesh.get_precision()))
+                return infinity;
+            facet = index;
+            on_side = pt_on_side;
+            closest = t;
+            return t;
+        }
+        const int get_facet() const { return facet; }
+        const bool get_on_side() const { return on_side; }
+    private:
+        const Mesh_3D& mesh;
+        const Point_3D& origin;
+        const Vector_3D& direction;
+        int facet;      // closest facet hit or -1
+        bool on_side;   // true if the closest hit is on a side of facet
+        Point_3D::Measurement closest;
+    };
+    
+    /*
+     * Location of p in relation to the mesh.  The facet planes and tree must
+     * already be cached.
+     */
+    static const Point_Location locate_point(const Mesh_3D& mesh, const Facet_Tree_3D& tree, const Point_3D& p)
+    {
+        // if point is on a facet, it is on the surface
+        class On_Facet {
+        public:
+            On_Facet(const Mesh_3D& m, const Point_3D& pt) : mesh(m), p(pt) {}
+            const bool operator()(const int index) const
             {
-                pt_on_surface = true;
-                return true;
+                if (!mesh.get_facet_plane(index).valid)
+                    return false;
+                bool pt_on_side(false);
+                return mesh.facet_view(index).contains_point(p, pt_on_side, mesh.get_precision());
             }
-            else if (outside_mesh) // if already found to be outside, 
-                continue;          // see if point is on a facet - no need to look if outside anymore
-//            (*iter)->set_debug(false);
-//            if (debug)
-//                cout << "    after facet contains point\n";
-            // determine if point is inside mesh by checking if 
-            // point is behind each closest facet
-            
-            // vector from point to facet
-            Point_3D inside_pt(iter->get_inside_point());
-            Vector_3D v(p, inside_pt);
-            bool closer_facet = false; // if there is a facet that is closer
+        private:
+            const Mesh_3D& mesh;
+            const Point_3D& p;
+        };
+        if (tree.find_if(p, On_Facet(mesh, p)) != -1)
+            return pt_on_mesh_surface;
+        
+        // determine if point is inside mesh by checking if point is behind the
+        // closest facet along a ray to the inside point of a facet.  If the 
+        // ray hits the closest facet on a side or nearly parallel to the facet,
+        // the next facet is used for the ray.
+        bool outside_mesh = false;
+        bool found_facet = false;
+        for (Mesh_3D::size_type index = 0; index < mesh.size(); ++index)
+        {
+            if (!mesh.get_facet_plane(index).valid)
+                continue;
             
-            // go through mesh again looking for possible facets that are closer
-            Point_3D i_point(0,0,0); // initialize here so it will be only assigned in loop
-//            int count = 0;
-            for (Mesh_3D::const_iterator it = mesh.begin(); it != mesh.end(); ++it)
-            {
-//                if (debug)
-//                    cout << "    closer facet loop " << count++ << " of " << facets.size() << "\n";
-                if (it == iter) // don't process the same facet
-                    continue;
-                // check if facet is in the same general direction and closer 
-                // than the *iter facet
-//                Vector_3D v2(p, (*it)->get_inside_point());
-//                if (dot_product(v2, v) >= 0 && v2.length() < v.length())
-//                {
-                    // see if line v from p intersects *it facet
-//                    if (intersect_line_facet_plane(v, p, **it, i_point, precision) && 
-//                            (*it)->contains_point(i_point, precision))
-                    if (intersect_line_facet_plane(v, p, *it, i_point, mesh.get_precision()) && 
-                            is_pt_on_vector(i_point, p, inside_pt, mesh.get_precision()) && 
-                            it->contains_point(i_point, pt_on_side, mesh.get_precision()))
-                    {
-                        // closer facet
-                        closer_facet = true;
-                        break;
-                    }
-//                }
-            }
+            Vector_3D v(p, mesh.facet_view(index).get_inside_point());
+            if (v.length() == 0)
+                continue;
+            v.normalize();
+            Closest_Facet_Hit hit(mesh, p, v);
+            tree.closest_hit(p, v, hit);
+            if (hit.get_facet() == -1)
+                continue;
             
-            if (!closer_facet) // this is the closest facet, so test
+            const Point_3D::Measurement cos_angle(dot_product(mesh.get_facet_plane(hit.get_facet()).unv, v));
+            const bool clear_hit(!hit.get_on_side() && fabs(cos_angle) > mesh.get_precision());
+            if (clear_hit || !found_facet)
             {
-//                if (debug)
-//                    cout << "closest facet v.length zero? " << within_round(v.length(), 0, precision) << "\n";
-                // if point is in front of facet
-                if (dot_product(iter->get_unv(), v.normalize()) < 0)
-                    outside_mesh = true;
+                // if point is in front of facet, point is outside
+                outside_mesh = cos_angle < 0;
+                found_facet = true;
             }
+            if (clear_hit)
+                break;
         }
-        
-        // if point is behind every closest facet, then the mesh contains the point
-        if (!outside_mesh)
+        return outside_mesh ? pt_outside_mesh : pt_inside_mesh;
+    }
+    
+    const bool mesh_contains_point(const Mesh_3D& mesh, const Point_3D& p, bool& pt_on_surface)
+    {
+        mesh.cache_facet_planes();
+        const Point_Location location(locate_point(mesh, mesh.get_facet_tree(), p));
+        if (location == pt_outside_mesh)
+            return false;
+        pt_on_surface = location == pt_on_mesh_surface;
+        return true;
+    }
+    
+    // locate_point query for run_queries
+    class Locate_Query {
+    public:
+        Locate_Query(const Mesh_3D& m, const Facet_Tree_3D& t, const vector<Point_3D>::const_iterator f) : 
+                mesh(m), tree(t), first(f) {}
+        const Point_Location operator()(const size_t index) const { return locate_point(mesh, tree, first[index]); }
+    private:
+        const Mesh_3D& mesh;
+        const Facet_Tree_3D& tree;
+        const vector<Point_3D>::const_iterator first;
+    };
+    
+    void mesh_contains_points(const Mesh_3D& mesh, const vector<Point_3D>::const_iterator first, 
+            const vector<Point_3D>::const_iterator last, vector<Point_Location>& locations, 
+            const unsigned int num_threads)
+    {
+        // build the caches before the threads share the mesh
+        mesh.cache_facet_planes();
+        run_queries(Locate_Query(mesh, mesh.get_facet_tree(), first), last - first, locations, num_threads);
+    }
+    
+    /*
+     * Finds the closest facet to a point for mesh_closest_point.
+     */
+    class Closest_Facet {
+    public:
+        Closest_Facet(const Mesh_3D& m, const Point_3D& pt) : mesh(m), p(pt), facet(-1), 
+                closest(0, 0, 0) {}
+        const Point_3D::Measurement operator()(const int index, const Point_3D::Measurement limit)
         {
-            pt_on_surface = false;
-            return true;
+            const Point_3D facet_pt(mesh.facet_view(index).closest_point(p));
+            const Point_3D::Measurement dx(facet_pt.get_x() - p.get_x());
+            const Point_3D::Measurement dy(facet_pt.get_y() - p.get_y());
+            const Point_3D::Measurement dz(facet_pt.get_z() - p.get_z());
+            const Point_3D::Measurement distance2(dx * dx + dy * dy + dz * dz);
+            if (distance2 >= limit)
+                return numeric_limits<Point_3D::Measurement>::infinity();
+            facet = index;
+            closest = facet_pt;
+            return distance2;
         }
-        else
+        const int get_facet() const { return facet; }
+        const Point_3D& get_closest() const { return closest; }
+    private:
+        const Mesh_3D& mesh;
+        const Point_3D& p;
+        int facet;          // closest facet found or -1
+        Point_3D closest;   // closest point on facet
+    };
+    
+    // mesh_closest_point with the tree already built
+    static const Point_3D::Measurement closest_point(const Mesh_3D& mesh, const Facet_Tree_3D& tree, 
+            const Point_3D& p, Point_3D& closest, int& facet)
+    {
+        Closest_Facet closest_facet(mesh, p);
+        const Point_3D::Measurement distance2(tree.closest_facet(p, closest_facet));
+        facet = closest_facet.get_facet();
+        if (facet == -1)
+            return numeric_limits<Point_3D::Measurement>::infinity();
+        closest = closest_facet.get_closest();
+        return sqrt(distance2);
+    }
+    
+    // mesh_signed_distance with the planes and tree already cached
+    static const Point_3D::Measurement signed_distance(const Mesh_3D& mesh, const Facet_Tree_3D& tree, 
+            const Point_3D& p)
+    {
+        Point_3D closest(0, 0, 0);
+        int facet(-1);
+        const Point_3D::Measurement distance(closest_point(mesh, tree, p, closest, facet));
+        if (facet == -1 || distance <= mesh.get_precision())
+            return facet == -1 ? distance : 0;
+        return locate_point(mesh, tree, p) == pt_inside_mesh ? -distance : distance;
+    }
+    
+    const Point_3D::Measurement mesh_closest_point(const Mesh_3D& mesh, const Point_3D& p, 
+            Point_3D& closest, int& facet)
+    {
+        return closest_point(mesh, mesh.get_facet_tree(), p, closest, facet);
+    }
+    
+    const Point_3D::Measurement mesh_distance(const Mesh_3D& mesh, const Point_3D& p)
+    {
+        Point_3D closest(0, 0, 0);
+        int facet(-1);
+        return closest_point(mesh, mesh.get_facet_tree(), p, closest, facet);
+    }
+    
+    const Point_3D::Measurement mesh_signed_distance(const Mesh_3D& mesh, const Point_3D& p)
+    {
+        mesh.cache_facet_planes();
+        return signed_distance(mesh, mesh.get_facet_tree(), p);
+    }
+    
+    // signed_distance query for run_queries
+    class Signed_Distance_Query {
+    public:
+        Signed_Distance_Query(const Mesh_3D& m, const Facet_Tree_3D& t, const vector<Point_3D>::const_iterator f) : 
+                mesh(m), tree(t), first(f) {}
+        const Point_3D::Measurement operator()(const size_t index) const 
+        { 
+            return signed_distance(mesh, tree, first[index]); 
+        }
+    private:
+        const Mesh_3D& mesh;
+        const Facet_Tree_3D& tree;
+        const vector<Point_3D>::const_iterator first;
+    };
+    
+    void mesh_signed_distances(const Mesh_3D& mesh, const vector<Point_3D>::const_iterator first, 
+            const vector<Point_3D>::const_iterator last, vector<Point_3D::Measurement>& distances, 
+            const unsigned int num_threads)
+    {
+        // build the caches before the threads share the mesh
+        mesh.cache_facet_planes();
+        run_queries(Signed_Distance_Query(mesh, mesh.get_facet_tree(), first), last - first, distances, num_threads);
+    }
+    
+    /*
+     * Finds the first facet hit by a ray for mesh_ray_hit using the Moller 
+     * Trumbore ray triangle test.
+     */
+    class First_Facet_Hit {
+    public:
+        First_Facet_Hit(const Mesh_3D& m, const Point_3D& o, const Vector_3D& v, Ray_Hit& h, 
+                const Point_3D::Measurement max) : mesh(m), origin(o), direction(v), hit(h), max_t(max) {}
+        const Point_3D::Measurement operator()(const int index)
+        {
+            const Point_3D::Measurement infinity(numeric_limits<Point_3D::Measurement>::infinity());
+            const Mesh_3D::Facet_View facet(mesh.facet_view(index));
+            const Vector_3D edge1(facet.get_point1(), facet.get_point2());
+            const Vector_3D edge2(facet.get_point1(), facet.get_point3());
+            const Vector_3D p(cross_product(direction, edge2));
+            const Point_3D::Measurement determinant(dot_product(edge1, p));
+            if (determinant == 0) // ray is parallel to facet or facet has no area
+                return infinity;
+            const Vector_3D s(facet.get_point1(), origin);
+            const Point_3D::Measurement u(dot_product(s, p) / determinant);
+            if (u < 0 || u > 1)
+                return infinity;
+            const Vector_3D q(cross_product(s, edge1));
+            const Point_3D::Measurement v(dot_product(direction, q) / determinant);
+            if (v < 0 || u + v > 1)
+                return infinity;
+            const Point_3D::Measurement t(dot_product(edge2, q) / determinant);
+            if (!(t > 0) || t > max_t || (hit.facet != -1 && t >= hit.t))
+                return infinity;
+            hit.facet = index;
+            hit.t = t;
+            hit.u = u;
+            hit.v = v;
+            return t;
+        }
+    private:
+        const Mesh_3D& mesh;
+        const Point_3D& origin;
+        const Vector_3D& direction;
+        Ray_Hit& hit;
+        const Point_3D::Measurement max_t;
+    };
+    
+    // mesh_ray_hit with the tree already built
+    static const bool ray_hit(const Mesh_3D& mesh, const Facet_Tree_3D& tree, const Point_3D& origin, 
+            const Vector_3D& direction, Ray_Hit& hit, const Point_3D::Measurement max_t)
+    {
+        Ray_Hit first_hit;
+        First_Facet_Hit intersect(mesh, origin, direction, first_hit, max_t);
+        tree.closest_hit(origin, direction, intersect);
+        if (first_hit.facet == -1)
             return false;
+        first_hit.point = origin + direction * first_hit.t;
+        hit = first_hit;
+        return true;
+    }
+    
+    const bool mesh_ray_hit(const Mesh_3D& mesh, const Point_3D& origin, const Vector_3D& direction, 
+            Ray_Hit& hit, const Point_3D::Measurement max_t)
+    {
+        return ray_hit(mesh, mesh.get_facet_tree(), origin, direction, hit, max_t);
+    }
+    
+    const bool mesh_segment_hit(const Mesh_3D& mesh, const Point_3D& p1, const Point_3D& p2, Ray_Hit& hit)
+    {
+        return ray_hit(mesh, mesh.get_facet_tree(), p1, Vector_3D(p1, p2), hit, 1);
+    }
+    
+    // ray_hit query for run_queries
+    class Ray_Hit_Query {
+    public:
+        Ray_Hit_Query(const Mesh_3D& m, const Facet_Tree_3D& t, const vector<Point_3D>::const_iterator f, 
+                const vector<Vector_3D>::const_iterator d) : mesh(m), tree(t), first(f), directions(d) {}
+        const Ray_Hit operator()(const size_t index) const 
+        { 
+            Ray_Hit hit;
+            ray_hit(mesh, tree, first[index], directions[index], hit, 
+                    numeric_limits<Point_3D::Measurement>::infinity());
+            return hit;
+        }
+    private:
+        const Mesh_3D& mesh;
+        const Facet_Tree_3D& tree;
+        const vector<Point_3D>::const_iterator first;
+        const vector<Vector_3D>::const_iterator directions;
+    };
+    
+    void mesh_ray_hits(const Mesh_3D& mesh, const vector<Point_3D>::const_iterator first, 
+            const vector<Point_3D>::const_iterator last, const vector<Vector_3D>::const_iterator directions, 
+            vector<Ray_Hit>& hits, const unsigned int num_threads)
+    {
+        // build the tree before the threads share the mesh
+        run_queries(Ray_Hit_Query(mesh, mesh.get_facet_tree(), first, directions), last - first, hits, num_threads);
     }
 }
@@ -20,15 +20,24 @@
 #ifndef MESH_3D_H
 #define MESH_3D_H
 
+#include <atomic>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <iterator>
+#include <limits>
+#include <unordered_map>
 #include "Point_3D.h"
+#include "Point_Grid_3D.h"
+#include "Point_Index.h"
 #include "Facet.h"
 #include "Facet_3D.h"
+#include "Transform_3D.h"
 
 namespace VCAD_lib
 {
+    class Facet_Tree_3D;
+    
     class Mesh_3D {
     private:
         class Facet_Find {
@@ -38,12 +47,24 @@ namespace VCAD_lib
         private:
             const Facet facet_to_find;
         };
+        
+        // find a point list index with a point within precision of pt
+        class Point_Match {
+        public:
+            Point_Match(const vector<shared_ptr<const Point_3D>>& points, const Point_3D& point, 
+                    const Point_3D::Measurement prec);
+            const bool operator()(const int index) const;
+        private:
+            const vector<shared_ptr<const Point_3D>>& point_list;
+            const Point_3D& pt;
+            const Point_3D::Measurement precision;
+        };
     public:
         class const_iterator {
         public:
             typedef bidirectional_iterator_tag iterator_category;
 
-            const_iterator(const vector<shared_ptr<Point_3D>>::const_iterator point_it_begin, 
+            const_iterator(const vector<shared_ptr<const Point_3D>>::const_iterator point_it_begin, 
                     const vector<Facet>::const_iterator facet_it_begin, 
                     const vector<Facet>::const_iterator facet_it_end, 
                     const vector<Facet>::const_iterator position);
@@ -59,29 +80,174 @@ namespace VCAD_lib
             const Facet_3D& operator*() const;
             const Facet_3D* const operator->() const;
         private:
-            vector<shared_ptr<Point_3D>>::const_iterator point_list_begin;
+            vector<shared_ptr<const Point_3D>>::const_iterator point_list_begin;
             vector<Facet>::const_iterator facets_begin;
             vector<Facet>::const_iterator facets_end;
             vector<Facet>::const_iterator current_facet;
             Facet_3D facet;
             void update_facet();
+            friend class Mesh_3D;
         };        
         
+        /*
+         * Plane of a facet: unit normal vector unv and offset so that points x
+         * on the plane have dot_product(unv, x) == offset.  valid is false for
+         * a facet whose points do not form a triangle (no unit normal).
+         */
+        struct Facet_Plane {
+            Vector_3D unv;
+            Point_3D::Measurement offset;
+            bool valid;
+            Facet_Plane(const Vector_3D& v, const Point_3D::Measurement d, const bool is_valid) : 
+                    unv(v), offset(d), valid(is_valid) {}
+        };
+        
+        /*
+         * A mesh facet that refers to the mesh points instead of copying them
+         * into a Facet_3D.  Creating a view does not allocate or validate the
+         * points.  A view is only valid until the mesh is changed.
+         */
+        class Facet_View {
+        public:
+            Facet_View(const Point_3D& pt1, const Point_3D& pt2, const Point_3D& pt3, 
+                    const Facet& facet, const Facet_Plane* facet_plane = nullptr) : 
+                    p1(&pt1), p2(&pt2), p3(&pt3), indices(facet), 
+                    plane(facet_plane != nullptr && facet_plane->valid ? facet_plane : nullptr) {}
+            // exception safety: no throw
+            const Point_3D& get_point1() const { return *p1; }
+            // exception safety: no throw
+            const Point_3D& get_point2() const { return *p2; }
+            // exception safety: no throw
+            const Point_3D& get_point3() const { return *p3; }
+            // exception safety: no throw
+            const Facet& get_facet() const { return indices; }
+            // exception safety: no throw
+            const int get_p1_index() const { return indices.get_p1_index(); }
+            // exception safety: no throw
+            const int get_p2_index() const { return indices.get_p2_index(); }
+            // exception safety: no throw
+            const int get_p3_index() const { return indices.get_p3_index(); }
+            // exception safety: strong guarantee throws length_error if calculated vector has zero length
+            const Vector_3D get_unv() const { return plane != nullptr ? plane->unv : facet_unv(*p1, *p2, *p3); }
+            // exception safety: no throw.  null if the mesh plane cache was not used
+            const Facet_Plane* get_plane() const { return plane; }
+            // exception safety: no throw
+            const Point_3D get_inside_point() const { return facet_inside_point(*p1, *p2, *p3); }
+            // exception safety: no throw
+            const Point_3D closest_point(const Point_3D& pt) const { return facet_closest_point(*p1, *p2, *p3, pt); }
+            const bool contains_point(const Point_3D& pt, bool& pt_is_on_side, 
+                    const Point_3D::Measurement precision) const
+            {
+                if (plane != nullptr)
+                    return facet_contains_point(*p1, *p2, *p3, plane->unv, pt, pt_is_on_side, precision);
+                return facet_contains_point(*p1, *p2, *p3, pt, pt_is_on_side, precision);
+            }
+        private:
+            const Point_3D* p1;
+            const Point_3D* p2;
+            const Point_3D* p3;
+            Facet indices;
+            const Facet_Plane* plane;
+        };
+        
+        /*
+         * Random access iterator over the mesh facets as Facet_Views.  
+         * Dereferencing returns a Facet_View by value.
+         */
+        class const_view_iterator {
+        public:
+            // holds a Facet_View for operator->
+            class pointer {
+            public:
+                pointer(const Facet_View& v) : view(v) {}
+                const Facet_View* operator->() const { return &view; }
+            private:
+                const Facet_View view;
+            };
+            typedef random_access_iterator_tag iterator_category;
+            typedef Facet_View value_type;
+            typedef vector<Facet>::difference_type difference_type;
+            typedef const Facet_View reference;
+            
+            // planes_begin is the plane of the first facet or null to calculate planes
+            const_view_iterator(const vector<shared_ptr<const Point_3D>>::const_iterator point_it_begin, 
+                    const vector<Facet>::const_iterator facet_it_begin, 
+                    const vector<Facet>::const_iterator position, 
+                    const Facet_Plane* planes_begin = nullptr) : 
+                    point_list_begin(point_it_begin), facets_begin(facet_it_begin), 
+                    current_facet(position), planes(planes_begin) {}
+            
+            bool operator==(const const_view_iterator& it) const { return current_facet == it.current_facet; }
+            bool operator!=(const const_view_iterator& it) const { return current_facet != it.current_facet; }
+            bool operator<(const const_view_iterator& it) const { return current_facet < it.current_facet; }
+            bool operator>(const const_view_iterator& it) const { return current_facet > it.current_facet; }
+            bool operator<=(const const_view_iterator& it) const { return current_facet <= it.current_facet; }
+            bool operator>=(const const_view_iterator& it) const { return current_facet >= it.current_facet; }
+            
+            const_view_iterator& operator++() { ++current_facet; return *this; }
+            const_view_iterator operator++(int) { const_view_iterator orig(*this); ++current_facet; return orig; }
+            const_view_iterator& operator--() { --current_facet; return *this; }
+            const_view_iterator operator--(int) { const_view_iterator orig(*this); --current_facet; return orig; }
+            const_view_iterator& operator+=(const difference_type n) { current_facet += n; return *this; }
+            const_view_iterator& operator-=(const difference_type n) { current_facet -= n; return *this; }
+            const_view_iterator operator+(const difference_type n) const { const_view_iterator it(*this); return it += n; }
+            const_view_iterator operator-(const difference_type n) const { const_view_iterator it(*this); return it -= n; }
+            difference_type operator-(const const_view_iterator& it) const { return current_facet - it.current_facet; }
+            
+            const Facet_View operator*() const
+            {
+                return Facet_View(**(point_list_begin + current_facet->get_p1_index()), 
+                        **(point_list_begin + current_facet->get_p2_index()), 
+                        **(point_list_begin + current_facet->get_p3_index()), *current_facet, 
+                        planes != nullptr ? planes + (current_facet - facets_begin) : nullptr);
+            }
+            const pointer operator->() const { return pointer(**this); }
+            const Facet_View operator[](const difference_type n) const { return *(*this + n); }
+        private:
+            vector<shared_ptr<const Point_3D>>::const_iterator point_list_begin;
+            vector<Facet>::const_iterator facets_begin;
+            vector<Facet>::const_iterator current_facet;
+            const Facet_Plane* planes;
+        };
+        
         typedef vector<Facet>::size_type size_type;
         typedef Point_3D::Measurement Measurement;
         typedef Point_3D::Angle_Meas Angle_Meas;
-        // to allow for users to get point list and facet point indices
-        typedef vector<shared_ptr<Point_3D>>::const_iterator const_point_iterator;
+        // to allow for users to get point list and facet point indices.  The points can not be changed
+        typedef vector<shared_ptr<const Point_3D>>::const_iterator const_point_iterator;
         typedef vector<Facet>::const_iterator const_facet_iterator;
         
         // exception safety: strong guarantee
         Mesh_3D();
         // exception safety: strong guarantee - invalid_argument if precision is less than or equal to zero
         explicit Mesh_3D(const Measurement precision); // precision
-        // exception safety: strong guarantee
+        /*
+         * create a mesh from flat point and facet arrays.  See append.
+         * 
+         * exception safety: strong guarantee - invalid_argument if precision is less than or equal to zero
+         *                   or if the arrays are not valid
+         */
+        Mesh_3D(const Measurement precision, const vector<Measurement>& coords, 
+                const vector<int>& indices);
+        /*
+         * copies share points and facets until one of them is changed, when 
+         * the changed mesh makes its own copy.  point_begin gives const 
+         * pointers to the shared points and the Facet_3D of a const_iterator
+         * has its own copy of the facet points, so a mesh can only be changed
+         * through its own methods.
+         * 
+         * exception safety: strong guarantee
+         */
         Mesh_3D(const Mesh_3D& orig);
         // exception safety: strong guarantee
         Mesh_3D& operator=(const Mesh_3D&);
+        // orig is left as an empty mesh with the same precision
+        // exception safety: no throw
+        Mesh_3D(Mesh_3D&& orig) noexcept;
+        // exception safety: no throw
+        Mesh_3D& operator=(Mesh_3D&& other) noexcept;
+        // exception safety: no throw
+        void swap(Mesh_3D& other) noexcept;
         // exception safety: no throw
         Measurement get_precision() const { return precision; }
         // iterators
@@ -90,27 +256,133 @@ namespace VCAD_lib
         const_iterator end() const;
         const_iterator cend() const;
         
-        const_point_iterator point_begin() const { return point_list.cbegin(); }
-        const_point_iterator point_end() const { return point_list.cend(); }
-        const_facet_iterator facet_begin() const { return facet_list.cbegin(); }
-        const_facet_iterator facet_end() const { return facet_list.cend(); }
+        const_point_iterator point_begin() const { return data->point_list.cbegin(); }
+        const_point_iterator point_end() const { return data->point_list.cend(); }
+        const_facet_iterator facet_begin() const { return data->facet_list.cbegin(); }
+        const_facet_iterator facet_end() const { return data->facet_list.cend(); }
+        // facet view iterators.  Views use the facet plane cache if it is up to date
+        const_view_iterator view_begin() const;
+        const_view_iterator view_end() const;
+        // exception safety: no throw. index must be less than size()
+        const Facet_View facet_view(const size_type index) const { return view_begin()[index]; }
         
+        /*
+         * add a facet.  Facet points that exactly match a mesh point use the
+         * mesh point.  If weld points is on, facet points that are within 
+         * precision of a mesh point (see is_equal) use the mesh point and a 
+         * facet that would have two of the same points is not added.  The 
+         * points of a facet that is not added are not added either.
+         */
         void push_back(const Facet_3D& facet);
-        size_type size() const { return facet_list.size(); }
-        bool empty() const { return facet_list.empty(); }
+        /*
+         * add points and facets from flat arrays in one pass.  coords holds the 
+         * x, y, and z of each point.  indices holds the three point indices of 
+         * each facet in counter-clockwise order, where index 0 is the first 
+         * point in coords.  Points are added as given, without looking for 
+         * points the mesh already has (use weld to merge them), and facets are 
+         * only checked for out of range or repeated indices.
+         * 
+         * exception safety: strong guarantee - invalid_argument if coords or 
+         *                   indices size is not a multiple of three or if a 
+         *                   facet has an invalid index
+         */
+        void append(const vector<Measurement>& coords, const vector<int>& indices);
+        // exception safety: strong guarantee
+        void reserve(const size_type num_points, const size_type num_facets);
+        // exception safety: no throw
+        const bool get_weld_points() const { return weld_points; }
+        // exception safety: no throw
+        void set_weld_points(const bool weld);
+        /*
+         * merge points that are within tolerance of each other (see is_equal).
+         * Facets are updated to use the merged points and facets that end up
+         * with two of the same points are removed.  Point indices can change.
+         * 
+         * exception safety: strong guarantee - invalid_argument if tolerance is less than or equal to zero
+         */
+        Mesh_3D& weld(const Measurement tolerance);
+        /*
+         * calculate the plane of every facet if the planes are not already 
+         * cached.  The cache is cleared by any change to the mesh.  Views 
+         * created while the cache is up to date read the unit normal vector 
+         * from the cache instead of calculating it.  Several threads can 
+         * call it on the same mesh as long as none of them changes the mesh.
+         * 
+         * exception safety: strong guarantee
+         */
+        void cache_facet_planes() const;
+        // the cached plane of the facet at index (calls cache_facet_planes)
+        // exception safety: strong guarantee - out_of_range if index is not less than size()
+        const Facet_Plane& get_facet_plane(const size_type index) const;
+        /*
+         * bounding volume hierarchy of the facets.  The tree is built the first
+         * time it is needed after a change to the mesh and is shared by the
+         * callers until the next change.  Several threads can call it on the 
+         * same mesh as long as none of them changes the mesh.
+         * 
+         * exception safety: strong guarantee
+         */
+        const Facet_Tree_3D& get_facet_tree() const;
+        size_type size() const { return data->facet_list.size(); }
+        bool empty() const { return data->facet_list.empty(); }
         void clear();
+        // erase facets.  Points are not removed (see remove_unused_points).
+        // returns an iterator to the facet after the last facet erased
+        // exception safety: strong guarantee
         const_iterator erase(const_iterator it);
+        // exception safety: strong guarantee
         const_iterator erase(const_iterator begin, const_iterator end);
+        /*
+         * erase the facet at index by moving the last facet into its place.
+         * Constant time, but the order of the facets is not kept.
+         * 
+         * exception safety: strong guarantee - out_of_range if index is not less than size()
+         */
+        void erase_unordered(const size_type index);
+        /*
+         * remove every facet for which pred(const Facet_View&) returns true in 
+         * one pass, keeping the order of the remaining facets.  If 
+         * remove_unused is true, points no longer used by a facet are removed 
+         * too (see remove_unused_points).  Returns the number of facets removed.
+         * 
+         * exception safety: basic guarantee
+         */
+        template <class Predicate>
+        const size_type remove_facets_if(Predicate pred, const bool remove_unused = false);
+        /*
+         * remove points that are not used by any facet.  Point indices can 
+         * change.  Returns the number of points removed.
+         * 
+         * exception safety: strong guarantee
+         */
+        const size_type remove_unused_points();
+        /*
+         * merge points with exactly the same coordinates, the same way 
+         * push_back does.  Facets that end up with two of the same points are
+         * removed.  Point indices can change.  Returns the number of points 
+         * merged.
+         * 
+         * exception safety: strong guarantee
+         */
+        const size_type merge_duplicate_points();
 //        const_iterator insert(const_iterator loc, const Facet_3D& facet);
 //        const_iterator insert(const_iterator loc, const_iterator from_facet, const_iterator to_facet);
+        /*
+         * apply the transform to every point in one pass.  If the transform 
+         * mirrors the mesh (negative determinant), the facet points are 
+         * reordered to keep the unit normal vectors pointing out.
+         * 
+         * exception safety: no throw
+         */
+        Mesh_3D& transform(const Transform_3D& t);
         // rotate
-        // exception safety: basic guarantee
+        // exception safety: no throw
         Mesh_3D& rotate(const Angle& angle);
-        // exception safety: basic guarantee
+        // exception safety: no throw
         Mesh_3D& rotate(const Angle_Meas angle, const Vector_3D& axis);
-        // exception safety: basic guarantee
+        // exception safety: no throw
         Mesh_3D& rotate(const Angle& angle, const Point_3D& origin);
-        // exception safety: basic guarantee
+        // exception safety: no throw
         Mesh_3D& rotate(const Angle_Meas angle, const Vector_3D& axis, const Point_3D& origin);
         // scale
         // exception safety: basic guarantee
@@ -138,7 +410,7 @@ namespace VCAD_lib
          * is identifying where the third point is located - xy plane, xz plane,
          * or yz plane.
          * 
-         * exception safety: basic guarantee
+         * exception safety: strong guarantee - length_error if an axis has zero length
          */
         Mesh_3D& move_x_pxy(const Point_3D& new_origin, const Vector_3D& x_axis, 
                 const Point_3D& pt_xy_plane, const Point_3D& ref_origin=Point_3D(0,0,0));
@@ -158,17 +430,191 @@ namespace VCAD_lib
         // exception safety: basic guarantee
         Mesh_3D& operator*=(const Measurement);
     private:
+        /*
+         * points are stored in blocks of contiguous Point_3D and point_list
+         * shares ownership of the blocks.  A block never grows past the size it
+         * was reserved with, so point addresses do not change.
+         */
+        typedef vector<Point_3D> Point_Block;
+        static const size_type point_block_size = 1024;
+        
+        /*
+         * points and facets of the mesh.  Copies of a mesh share the same 
+         * Mesh_Data until one of them is changed (see detach).
+         */
+        struct Mesh_Data {
+            vector<shared_ptr<const Point_3D>> point_list;
+            vector<Facet> facet_list;
+            // storage for the points in point_list
+            vector<shared_ptr<Point_Block>> point_blocks;
+        };
+        
+        /*
+         * shared by moved from meshes so a move does not allocate.  Never 
+         * changed, since detach copies it before a change.
+         */
+        static const shared_ptr<Mesh_Data> empty_data;
+        
         Measurement precision;
-        vector<shared_ptr<Point_3D>> point_list;
-        vector<Facet> facet_list;
+        shared_ptr<Mesh_Data> data;
+        // point_list index lookup by exact coordinates
+        unordered_map<Point_Key,int,Point_Key_Hasher> point_index;
+        // false when point coordinates have changed since point_index was built
+        bool point_index_valid;
+        // push_back welds points within precision when true
+        bool weld_points;
+        // point_list indices by location.  Only kept when weld_points is true
+        Point_Grid_3D weld_grid;
+        // weld_grid cell size is precision * weld_scale
+        Measurement weld_scale;
+        mutable vector<Facet_Plane> facet_planes;
+        // set after facet_planes is built, so a thread that sees it can read the planes
+        mutable atomic<bool> facet_planes_valid;
+        // null until get_facet_tree is called after a change
+        mutable shared_ptr<const Facet_Tree_3D> facet_tree;
+        // set after facet_tree is built, so a thread that sees it can use the tree
+        mutable atomic<bool> facet_tree_valid;
+        // held while a cache is built, so const queries can build it from several threads
+        mutable mutex cache_mutex;
+        
+        // clear facet_planes and facet_tree.  Called by every change to the mesh
+        void clear_facet_caches()
+        {
+            facet_planes_valid = false;
+            facet_tree_valid = false;
+            facet_tree.reset();
+        }
+        
+        // copy from_list points into a new block of to_blocks and add them to to_list
+        static void copy_points(const vector<shared_ptr<const Point_3D>>& from_list, 
+                vector<shared_ptr<const Point_3D>>& to_list, vector<shared_ptr<Point_Block>>& to_blocks);
+        // give this mesh its own copy of data if it is shared with another mesh.
+        // Must be called before data is changed.
+        void detach();
+        // add pt to point_blocks and return a pointer to it
+        const shared_ptr<const Point_3D> new_point(const Point_3D& pt);
+        // rebuild point_index (and weld_grid) from point_list if point coordinates have changed
+        void update_point_index();
+        // rebuild weld_grid from point_list using the current weld_scale
+        void build_weld_grid();
+        // return the index of pt in point_list, adding it if it is not found
+        const int find_or_add_point(const Point_3D& pt);
+        // return the index of a point within precision of pt or -1 if there is none
+        const int find_weld_point(const Point_3D& pt);
+        // add pt to point_list and weld_grid and return its index
+        const int add_weld_point(const Point_3D& pt);
     };
 
+    template <class Predicate>
+    const Mesh_3D::size_type Mesh_3D::remove_facets_if(Predicate pred, const bool remove_unused)
+    {
+        detach();
+        // move the facets to keep to the front
+        vector<Facet>::iterator keep(data->facet_list.begin());
+        for (const_view_iterator it = view_begin(); it != view_end(); ++it)
+        {
+            if (!pred(*it))
+                *keep++ = it->get_facet();
+        }
+        const size_type removed(data->facet_list.end() - keep);
+        data->facet_list.erase(keep, data->facet_list.end());
+        clear_facet_caches();
+        if (remove_unused)
+            remove_unused_points();
+        return removed;
+    }
+
     /*
      * Determine if a point is on or inside the mesh.  If the point is on or inside the
      * mesh, then pt_on_surface is set to true if the point is on the surface, or false
-     * it the point is inside the mesh
+     * it the point is inside the mesh.  Uses the mesh facet tree (see 
+     * get_facet_tree), so checking many points against the same mesh only 
+     * builds the tree once.
      */
     const bool mesh_contains_point(const Mesh_3D& mesh, const Point_3D& p, bool& pt_on_surface);
+    
+    // location of a point in relation to a mesh
+    enum Point_Location { pt_outside_mesh, pt_inside_mesh, pt_on_mesh_surface };
+    
+    /*
+     * Determine the location of every point from first to last in relation to
+     * the mesh, the same as mesh_contains_point.  locations is replaced with 
+     * one location for each point in the same order.
+     * 
+     * The mesh facet planes and tree are built once before the points are 
+     * split between num_threads threads (0 uses the number of hardware 
+     * threads), so the mesh must not be changed by another thread during the
+     * call.
+     * 
+     * exception safety: strong guarantee
+     */
+    void mesh_contains_points(const Mesh_3D& mesh, const vector<Point_3D>::const_iterator first, 
+            const vector<Point_3D>::const_iterator last, vector<Point_Location>& locations, 
+            const unsigned int num_threads = 0);
+    
+    /*
+     * Find the point on the surface of the mesh closest to p.  closest is set
+     * to that point and facet to the index of the facet it is on.  Returns 
+     * the distance from p to closest, or infinity (closest not changed and 
+     * facet set to -1) if the mesh has no facets.  Uses the mesh facet tree,
+     * visiting the nearest facets first, so a query is O(log N) for a 
+     * typical mesh.
+     */
+    const Point_3D::Measurement mesh_closest_point(const Mesh_3D& mesh, const Point_3D& p, 
+            Point_3D& closest, int& facet);
+    // distance from p to the surface of the mesh
+    const Point_3D::Measurement mesh_distance(const Mesh_3D& mesh, const Point_3D& p);
+    /*
+     * distance from p to the surface of the mesh.  Negative if p is inside 
+     * the mesh and 0 if it is on the surface (see mesh_contains_point).
+     */
+    const Point_3D::Measurement mesh_signed_distance(const Mesh_3D& mesh, const Point_3D& p);
+    /*
+     * mesh_signed_distance of every point from first to last.  distances is
+     * replaced with one distance for each point in the same order.  The 
+     * points are split between threads the same as mesh_contains_points.
+     * 
+     * exception safety: strong guarantee
+     */
+    void mesh_signed_distances(const Mesh_3D& mesh, const vector<Point_3D>::const_iterator first, 
+            const vector<Point_3D>::const_iterator last, vector<Point_3D::Measurement>& distances, 
+            const unsigned int num_threads = 0);
+    
+    /*
+     * Where a ray hits a mesh.  The hit point is 
+     * p1 * (1 - u - v) + p2 * u + p3 * v of the facet points.
+     */
+    struct Ray_Hit {
+        int facet;                  // index of the facet hit or -1 if nothing was hit
+        Point_3D::Measurement t;    // hit point is origin + t * direction
+        Point_3D point;
+        Point_3D::Measurement u;    // barycentric coordinate of facet point 2
+        Point_3D::Measurement v;    // barycentric coordinate of facet point 3
+        Ray_Hit() : facet(-1), t(0), point(0, 0, 0), u(0), v(0) {}
+    };
+    
+    /*
+     * Find the first facet hit by the ray origin + t * direction with 
+     * 0 < t <= max_t.  direction does not need to be a unit vector; t is in 
+     * lengths of direction.  Returns true and sets hit if a facet was hit.  
+     * A ray through a side shared by two facets hits one of them.  Uses the 
+     * mesh facet tree.
+     */
+    const bool mesh_ray_hit(const Mesh_3D& mesh, const Point_3D& origin, const Vector_3D& direction, 
+            Ray_Hit& hit, const Point_3D::Measurement max_t = numeric_limits<Point_3D::Measurement>::infinity());
+    // first facet hit by the segment from p1 to p2 (see mesh_ray_hit)
+    const bool mesh_segment_hit(const Mesh_3D& mesh, const Point_3D& p1, const Point_3D& p2, Ray_Hit& hit);
+    /*
+     * mesh_ray_hit of the rays with origins from first to last and the 
+     * directions starting at directions.  hits is replaced with one hit for 
+     * each ray in the same order (facet -1 for a miss).  The rays are split 
+     * between threads the same as mesh_contains_points.
+     * 
+     * exception safety: strong guarantee
+     */
+    void mesh_ray_hits(const Mesh_3D& mesh, const vector<Point_3D>::const_iterator first, 
+            const vector<Point_3D>::const_iterator last, const vector<Vector_3D>::const_iterator directions, 
+            vector<Ray_Hit>& hits, const unsigned int num_threads = 0);
 }
 
 #endif /* MESH2_3D_H */
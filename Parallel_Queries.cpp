@@ -0,0 +1,33 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Parallel_Queries.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Parallel_Queries.h"
+#include <algorithm>
+
+namespace VCAD_lib
+{
+    const size_t query_threads(const unsigned int num_threads, const size_t size, 
+            const size_t min_per_thread)
+    {
+        size_t threads(num_threads == 0 ? thread::hardware_concurrency() : num_threads);
+        if (min_per_thread > 0)
+            threads = min(threads, size / min_per_thread);
+        return max(static_cast<size_t>(1), threads);
+    }
+}
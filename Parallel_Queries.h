@@ -0,0 +1,115 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Parallel_Queries.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef PARALLEL_QUERIES_H
+#define PARALLEL_QUERIES_H
+
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace VCAD_lib
+{
+    /*
+     * Number of threads to use for size queries.  num_threads of 0 uses the
+     * number of hardware threads.  Fewer threads are used if there are not
+     * at least min_per_thread queries for each thread.  Always at least 1.
+     * 
+     * exception safety: no throw
+     */
+    const size_t query_threads(const unsigned int num_threads, const size_t size, 
+            const size_t min_per_thread);
+
+    /*
+     * Runs a query on a range of indexes for run_queries.  Run by each thread.
+     */
+    template <class Query, class Result>
+    class Query_Worker {
+    public:
+        Query_Worker(const Query& q, const size_t f, const size_t l, vector<Result>& r, 
+                exception_ptr& e) : query(q), first(f), last(l), results(r), error(e) {}
+        void operator()() const
+        {
+            try
+            {
+                for (size_t index = first; index < last; ++index)
+                    results[index] = query(index);
+            }
+            catch (...)
+            {
+                error = current_exception();
+            }
+        }
+    private:
+        const Query& query;
+        const size_t first;
+        const size_t last;
+        vector<Result>& results;
+        exception_ptr& error;
+    };
+    
+    /*
+     * Set results to query(index) for every index less than size, splitting 
+     * the indexes between num_threads threads (0 uses the number of hardware 
+     * threads).  A thread is not started for less than min_per_thread 
+     * queries.  query must only read shared data or change data that only 
+     * belongs to index.  The first exception thrown by a query is rethrown
+     * after all the threads finish.
+     * 
+     * exception safety: strong guarantee for results
+     */
+    template <class Query, class Result>
+    void run_queries(const Query& query, const size_t size, vector<Result>& results, 
+            const unsigned int num_threads, const size_t min_per_thread = 256)
+    {
+        const size_t threads(query_threads(num_threads, size, min_per_thread));
+        vector<Result> result(size);
+        vector<exception_ptr> errors(threads);
+        vector<thread> workers;
+        workers.reserve(threads - 1);
+        try
+        {
+            // the calling thread does the first range of queries
+            for (size_t i = 1; i < threads; ++i)
+                workers.push_back(thread(Query_Worker<Query,Result>(query, size * i / threads, 
+                        size * (i + 1) / threads, result, errors[i])));
+        }
+        catch (...)
+        {
+            for (typename vector<thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+                it->join();
+            throw;
+        }
+        Query_Worker<Query,Result>(query, 0, size / threads, result, errors[0])();
+        for (typename vector<thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+            it->join();
+        
+        for (vector<exception_ptr>::const_iterator it = errors.begin(); it != errors.end(); ++it)
+        {
+            if (*it)
+                rethrow_exception(*it);
+        }
+        results.swap(result);
+    }
+}
+
+#endif /* PARALLEL_QUERIES_H */
@@ -213,31 +213,6 @@ namespace VCAD_lib
         return *this;
     }
 
-    Point_3D& Point_3D::scale(const Point_3D::Measurement x_scalar, const Point_3D::Measurement y_scalar, const Point_3D::Measurement z_scalar)
-    {
-        x *= x_scalar;
-        y *= y_scalar;
-        z *= z_scalar;
-        return *this;
-    }
-
-    Point_3D& Point_3D::scale(const Point_3D::Measurement x_scalar, const Point_3D::Measurement y_scalar, const Point_3D::Measurement z_scalar,
-            const Point_3D& origin)
-    {
-        x = origin.x + (x - origin.x) * x_scalar;
-        y = origin.y + (y - origin.y) * y_scalar;
-        z = origin.z + (z - origin.z) * z_scalar;
-        return *this;
-    }
-
-    Point_3D& Point_3D::translate(const Point_3D::Measurement x_val, const Point_3D::Measurement y_val, const Point_3D::Measurement z_val)
-    {
-        x += x_val;
-        y += y_val;
-        z += z_val;
-        return *this;
-    }
-
     Point_3D& Point_3D::translate(const Vector_3D& vector)
     {
         x += vector.get_x();
@@ -61,13 +61,32 @@ namespace VCAD_lib
         Point_3D& rotate(const Angle& angle, const Point_3D& origin);
         Point_3D& rotate(const Angle_Meas angle, const Vector_3D& axis, 
                 const Point_3D& origin);
+        // scale and translate are inline so mesh point loops can be vectorized
         Point_3D& scale(const Measurement x_scalar, 
-                const Measurement y_scalar, const Measurement z_scalar);
+                const Measurement y_scalar, const Measurement z_scalar)
+        {
+            x *= x_scalar;
+            y *= y_scalar;
+            z *= z_scalar;
+            return *this;
+        }
         Point_3D& scale(const Measurement x_scalar, 
                 const Measurement y_scalar, const Measurement z_scalar, 
-                const Point_3D& origin);
+                const Point_3D& origin)
+        {
+            x = origin.x + (x - origin.x) * x_scalar;
+            y = origin.y + (y - origin.y) * y_scalar;
+            z = origin.z + (z - origin.z) * z_scalar;
+            return *this;
+        }
         Point_3D& translate(const Measurement x_val, const Measurement y_val, 
-                const Measurement z_val);
+                const Measurement z_val)
+        {
+            x += x_val;
+            y += y_val;
+            z += z_val;
+            return *this;
+        }
         Point_3D& translate(const Vector_3D&);
         /*
          * move the point to a different coordinate system and origin.
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Point_Grid_3D.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Point_Grid_3D.h"
+#include <cfloat>
+#include <cmath>
+#include <functional>
+#include <stdexcept>
+#include "Point_Index.h"
+
+namespace VCAD_lib
+{
+    // keep cell coordinates well away from overflow when neighbours are searched
+    static const double max_cell_coord = 4611686018427387904.0; // 2^62
+
+    Point_Grid_3D::Cell_Key::Cell_Key(const long long x_val, const long long y_val, 
+            const long long z_val) : x(x_val), y(y_val), z(z_val) {}
+
+    const bool Point_Grid_3D::Cell_Key::operator==(const Cell_Key& key) const
+    {
+        return x == key.x && y == key.y && z == key.z;
+    }
+
+    const size_t Point_Grid_3D::Cell_Key_Hasher::operator()(const Cell_Key& key) const
+    {
+        hash<long long> hasher;
+        size_t hash_value = hasher(key.x);
+        hash_combine(hash_value, hasher(key.y));
+        hash_combine(hash_value, hasher(key.z));
+        return hash_value;
+    }
+
+    Point_Grid_3D::Point_Grid_3D(const Measurement size) : cell_size(size), cells(), entries()
+    {
+        if (!(cell_size > 0))
+            throw invalid_argument("cell size must be greater than zero");
+    }
+
+    void Point_Grid_3D::clear()
+    {
+        cells.clear();
+        entries.clear();
+    }
+
+    void Point_Grid_3D::clear(const Measurement new_cell_size)
+    {
+        if (!(new_cell_size > 0))
+            throw invalid_argument("cell size must be greater than zero");
+        clear();
+        cell_size = new_cell_size;
+    }
+
+    void Point_Grid_3D::reserve(const size_type num_points)
+    {
+        cells.reserve(num_points);
+        entries.reserve(num_points);
+    }
+
+    void Point_Grid_3D::insert(const Point_3D& pt, const int index)
+    {
+        const Cell_Key key(cell_key(pt));
+        entries.push_back(Entry(index, -1));
+        const int entry(entries.size() - 1);
+        try
+        {
+            pair<unordered_map<Cell_Key,pair<int,int>,Cell_Key_Hasher>::iterator,bool> result = 
+                    cells.insert(pair<Cell_Key,pair<int,int>>(key, pair<int,int>(entry, entry)));
+            if (!result.second) // cell already has entries, so link to the last one
+            {
+                entries[result.first->second.second].next = entry;
+                result.first->second.second = entry;
+            }
+        }
+        catch (...)
+        {
+            entries.pop_back();
+            throw;
+        }
+    }
+
+    const long long Point_Grid_3D::cell_coord(const Measurement val) const
+    {
+        Measurement coord(floor(val / cell_size));
+        if (coord > max_cell_coord)
+            return static_cast<long long>(max_cell_coord);
+        if (coord < -max_cell_coord)
+            return static_cast<long long>(-max_cell_coord);
+        if (coord != coord) // NaN
+            return 0;
+        return static_cast<long long>(coord);
+    }
+
+    const Point_Grid_3D::Cell_Key Point_Grid_3D::cell_key(const Point_3D& pt) const
+    {
+        return Cell_Key(cell_coord(pt.get_x()), cell_coord(pt.get_y()), cell_coord(pt.get_z()));
+    }
+
+    /*
+     * Finds the smallest index of a point that is_equal to pt.  Always 
+     * returns false, so Point_Grid_3D::find_if looks at every point near pt.
+     */
+    class First_Equal_Point {
+    public:
+        First_Equal_Point(const vector<Point_3D>& p, const Point_3D& point, 
+                const Point_3D::Measurement prec, int& first_index) : points(p), pt(point), 
+                precision(prec), first(first_index) {}
+        const bool operator()(const int index) const
+        {
+            if ((first == -1 || index < first) && is_equal(points[index], pt, precision))
+                first = index;
+            return false;
+        }
+    private:
+        const vector<Point_3D>& points;
+        const Point_3D& pt;
+        const Point_3D::Measurement precision;
+        int& first;
+    };
+
+    Equal_Point_Grid_3D::Equal_Point_Grid_3D(const Measurement prec) : precision(prec), 
+            scale(1), points(), grid(prec > 0 ? prec : 1)
+    {
+        if (!(precision > 0))
+            throw invalid_argument("precision must be greater than zero");
+    }
+
+    void Equal_Point_Grid_3D::clear()
+    {
+        points.clear();
+        grid.clear(precision);
+        scale = 1;
+    }
+
+    const int Equal_Point_Grid_3D::find(const Point_3D& pt) const
+    {
+        int first(-1);
+        if (cell_scale(pt, scale) != scale)
+        {
+            // pt can be farther than a cell from an equal point
+            for (vector<Point_3D>::size_type index = 0; index < points.size() && first == -1; ++index)
+            {
+                if (is_equal(points[index], pt, precision))
+                    first = index;
+            }
+            return first;
+        }
+        grid.find_if(pt, First_Equal_Point(points, pt, precision, first));
+        return first;
+    }
+
+    const int Equal_Point_Grid_3D::insert(const Point_3D& pt)
+    {
+        const Measurement new_scale(cell_scale(pt, scale));
+        if (new_scale != scale)
+        {
+            Point_Grid_3D new_grid(precision * new_scale);
+            new_grid.reserve(points.size() + 1);
+            for (vector<Point_3D>::size_type index = 0; index < points.size(); ++index)
+                new_grid.insert(points[index], index);
+            new_grid.insert(pt, points.size());
+            points.push_back(pt);
+            std::swap(grid, new_grid);
+            scale = new_scale;
+        }
+        else
+        {
+            points.push_back(pt);
+            try
+            {
+                grid.insert(pt, points.size() - 1);
+            }
+            catch (...)
+            {
+                points.pop_back();
+                throw;
+            }
+        }
+        return points.size() - 1;
+    }
+
+    const Equal_Point_Grid_3D::Measurement Equal_Point_Grid_3D::cell_scale(const Point_3D& pt, 
+            Measurement scale)
+    {
+        Measurement largest(fabs(pt.get_x()));
+        if (fabs(pt.get_y()) > largest)
+            largest = fabs(pt.get_y());
+        if (fabs(pt.get_z()) > largest)
+            largest = fabs(pt.get_z());
+        while (scale < largest && scale < DBL_MAX / 2)
+            scale *= 2;
+        return scale;
+    }
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Point_Grid_3D.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef POINT_GRID_3D_H
+#define POINT_GRID_3D_H
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include "Point_3D.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+
+    /*
+     * Spatial hash of point indices.  Space is divided into cubes of
+     * cell_size and each point index is stored in the cell containing the
+     * point.  Any two points that are within cell_size of each other in x, y,
+     * and z are in the same or neighbouring cells, so a search only needs to
+     * look at the 27 cells around a point.
+     *
+     * The grid only stores indices.  The caller owns the points and decides
+     * which of the indices found are a match.
+     */
+    class Point_Grid_3D {
+    private:
+        struct Cell_Key {
+            long long x;
+            long long y;
+            long long z;
+            Cell_Key(const long long x_val, const long long y_val, const long long z_val);
+            const bool operator==(const Cell_Key& key) const;
+        };
+
+        // Cell_Key hasher
+        struct Cell_Key_Hasher {
+            const size_t operator()(const Cell_Key& key) const;
+        };
+
+        // an index in a cell. next is the next entry in the same cell or -1
+        struct Entry {
+            int index;
+            int next;
+            Entry(const int i, const int n) : index(i), next(n) {}
+        };
+    public:
+        typedef Point_3D::Measurement Measurement;
+        typedef vector<Entry>::size_type size_type;
+
+        // exception safety: strong guarantee - invalid_argument if cell_size is less than or equal to zero
+        explicit Point_Grid_3D(const Measurement cell_size);
+        // exception safety: no throw
+        Measurement get_cell_size() const { return cell_size; }
+        // exception safety: no throw
+        size_type size() const { return entries.size(); }
+        // exception safety: no throw
+        bool empty() const { return entries.empty(); }
+        // exception safety: no throw
+        void clear();
+        // exception safety: strong guarantee - invalid_argument if new_cell_size is less than or equal to zero
+        void clear(const Measurement new_cell_size);
+        void reserve(const size_type num_points);
+        // add a point index at the point location
+        // exception safety: strong guarantee
+        void insert(const Point_3D& pt, const int index);
+        /*
+         * Search the 27 cells around pt and return the first index for which
+         * pred(index) returns true, or -1 if there is no such index.  Indices
+         * in the same cell are searched in the order they were inserted.
+         */
+        template <class Predicate>
+        const int find_if(const Point_3D& pt, Predicate pred) const;
+    private:
+        Measurement cell_size;
+        unordered_map<Cell_Key,pair<int,int>,Cell_Key_Hasher> cells; // cell to first and last entry
+        vector<Entry> entries;
+
+        const long long cell_coord(const Measurement val) const;
+        const Cell_Key cell_key(const Point_3D& pt) const;
+    };
+
+    template <class Predicate>
+    const int Point_Grid_3D::find_if(const Point_3D& pt, Predicate pred) const
+    {
+        if (entries.empty())
+            return -1;
+
+        const Cell_Key center(cell_key(pt));
+        for (long long x = center.x - 1; x <= center.x + 1; ++x)
+        {
+            for (long long y = center.y - 1; y <= center.y + 1; ++y)
+            {
+                for (long long z = center.z - 1; z <= center.z + 1; ++z)
+                {
+                    unordered_map<Cell_Key,pair<int,int>,Cell_Key_Hasher>::const_iterator cell = cells.find(Cell_Key(x, y, z));
+                    if (cell == cells.end())
+                        continue;
+                    for (int entry = cell->second.first; entry != -1; entry = entries[entry].next)
+                    {
+                        if (pred(entries[entry].index))
+                            return entries[entry].index;
+                    }
+                }
+            }
+        }
+        return -1;
+    }
+
+    /*
+     * Points indexed for finding a point that is_equal to another point
+     * without comparing it to every point.  is_equal allows a larger 
+     * difference for coordinates larger than 1, so the grid cells are 
+     * precision times the largest coordinate size inserted, rounded up to a
+     * power of two (see cell_scale).  The grid is rebuilt when a larger 
+     * point is inserted.  2D points can be used with a z of 0.
+     *
+     * Points get indices in the order they are inserted, so the caller can
+     * keep its own point data in the same order.
+     */
+    class Equal_Point_Grid_3D {
+    public:
+        typedef Point_3D::Measurement Measurement;
+        typedef vector<Point_3D>::size_type size_type;
+
+        // exception safety: strong guarantee - invalid_argument if prec is less than or equal to zero
+        explicit Equal_Point_Grid_3D(const Measurement prec);
+        // exception safety: no throw
+        size_type size() const { return points.size(); }
+        // exception safety: no throw
+        bool empty() const { return points.empty(); }
+        // exception safety: no throw
+        void clear();
+        /*
+         * index of the first point inserted that is_equal to pt, or -1 if
+         * there is none.  The same index comparing pt to every point in 
+         * order would find.
+         * 
+         * exception safety: strong guarantee
+         */
+        const int find(const Point_3D& pt) const;
+        // add pt and return its index
+        // exception safety: strong guarantee
+        const int insert(const Point_3D& pt);
+        /*
+         * the smallest power of two that is at least scale and the largest
+         * coordinate size of pt.  scale must be a power of two of at least 1.
+         * 
+         * exception safety: no throw
+         */
+        static const Measurement cell_scale(const Point_3D& pt, Measurement scale);
+    private:
+        Measurement precision;
+        Measurement scale;
+        vector<Point_3D> points;
+        Point_Grid_3D grid;
+    };
+}
+
+#endif /* POINT_GRID_3D_H */
+
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Point_Index.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Point_Index.h"
+#include <functional>
+
+namespace VCAD_lib
+{
+    Point_Key::Point_Key(const Point_3D& pt) :
+            x(pt.get_x() == 0 ? 0.0 : pt.get_x()),
+            y(pt.get_y() == 0 ? 0.0 : pt.get_y()),
+            z(pt.get_z() == 0 ? 0.0 : pt.get_z()) {}
+
+    Point_Key::Point_Key(const Point_2D& pt) :
+            x(pt.get_x() == 0 ? 0.0 : pt.get_x()),
+            y(pt.get_y() == 0 ? 0.0 : pt.get_y()),
+            z(0.0) {}
+
+    const bool Point_Key::operator==(const Point_Key& key) const
+    {
+        return x == key.x && y == key.y && z == key.z;
+    }
+
+    const size_t Point_Key_Hasher::operator()(const Point_Key& key) const
+    {
+        hash<Point_3D::Measurement> hasher;
+        size_t hash_value = hasher(key.x);
+        hash_combine(hash_value, hasher(key.y));
+        hash_combine(hash_value, hasher(key.z));
+        return hash_value;
+    }
+}
+
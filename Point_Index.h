@@ -0,0 +1,160 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Point_Index.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef POINT_INDEX_H
+#define POINT_INDEX_H
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Point_2D.h"
+#include "Point_3D.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+    /*
+     * combine value into the hash seed.  Used to hash keys with more than
+     * one value.
+     *
+     * exception safety: no throw
+     */
+    inline void hash_combine(size_t& seed, const size_t value)
+    {
+        seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    }
+
+    /*
+     * exact coordinate key used to index points.  -0.0 is stored as 0.0 so
+     * keys compare the same way as the point coordinates.  2D points have a
+     * z of 0.
+     */
+    struct Point_Key {
+        Point_3D::Measurement x;
+        Point_3D::Measurement y;
+        Point_3D::Measurement z;
+        // exception safety: no throw
+        explicit Point_Key(const Point_3D& pt);
+        // exception safety: no throw
+        explicit Point_Key(const Point_2D& pt);
+        // exception safety: no throw
+        const bool operator==(const Point_Key& key) const;
+    };
+
+    // Point_Key hasher
+    struct Point_Key_Hasher {
+        // exception safety: no throw
+        const size_t operator()(const Point_Key& key) const;
+    };
+
+    /*
+     * Index of a point list by exact coordinates, used by the intersect
+     * engine facet lists.  The index of the last point with each coordinates
+     * is kept.  The index is built the first time a point is looked up after
+     * it was invalidated, so point lists that are only read never build it.
+     * The point list is owned by the caller and must only be changed with
+     * add_point or followed by invalidate.
+     */
+    template <class Point>
+    class Point_Index {
+    public:
+        // is_valid is true if the point list is empty
+        // exception safety: no throw
+        explicit Point_Index(const bool is_valid = true) : index(), valid(is_valid) {}
+        // the point list was cleared
+        // exception safety: no throw
+        void clear() { index.clear(); valid = true; }
+        // the point list was changed other than by add_point
+        // exception safety: no throw
+        void invalidate() { index.clear(); valid = false; }
+        /*
+         * Find the facet points in points.  An index is -1 if there is no
+         * point with the same coordinates or if the point was already used
+         * for an earlier facet point.
+         *
+         * exception safety: strong guarantee
+         */
+        void find_points(const vector<shared_ptr<Point>>& points, const Point& p1,
+                const Point& p2, const Point& p3, int& p1_index, int& p2_index,
+                int& p3_index) const;
+        /*
+         * add pt to points and return its index
+         *
+         * exception safety: strong guarantee
+         */
+        const int add_point(vector<shared_ptr<Point>>& points, const shared_ptr<Point>& pt);
+    private:
+        mutable unordered_map<Point_Key,int,Point_Key_Hasher> index;
+        mutable bool valid;
+
+        // build index if it is not up to date
+        void update(const vector<shared_ptr<Point>>& points) const;
+    };
+
+    template <class Point>
+    void Point_Index<Point>::update(const vector<shared_ptr<Point>>& points) const
+    {
+        if (valid)
+            return;
+        index.clear();
+        index.reserve(points.size());
+        // later points replace earlier points with the same coordinates
+        for (typename vector<shared_ptr<Point>>::size_type i = 0; i < points.size(); ++i)
+            index[Point_Key(*points[i])] = i;
+        valid = true;
+    }
+
+    template <class Point>
+    void Point_Index<Point>::find_points(const vector<shared_ptr<Point>>& points,
+            const Point& p1, const Point& p2, const Point& p3, int& p1_index,
+            int& p2_index, int& p3_index) const
+    {
+        update(points);
+        unordered_map<Point_Key,int,Point_Key_Hasher>::const_iterator it(index.find(Point_Key(p1)));
+        p1_index = it != index.end() ? it->second : -1;
+        it = index.find(Point_Key(p2));
+        p2_index = it != index.end() && it->second != p1_index ? it->second : -1;
+        it = index.find(Point_Key(p3));
+        p3_index = it != index.end() && it->second != p1_index && it->second != p2_index ?
+                it->second : -1;
+    }
+
+    template <class Point>
+    const int Point_Index<Point>::add_point(vector<shared_ptr<Point>>& points,
+            const shared_ptr<Point>& pt)
+    {
+        update(points);
+        points.push_back(pt);
+        try
+        {
+            index[Point_Key(*pt)] = points.size() - 1;
+        }
+        catch (...)
+        {
+            points.pop_back();
+            throw;
+        }
+        return points.size() - 1;
+    }
+}
+
+#endif /* POINT_INDEX_H */
+
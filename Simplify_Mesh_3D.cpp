@@ -25,6 +25,7 @@
 #include <algorithm>
 #include <cmath>
 #include <iostream>
+#include "Half_Edge_Mesh.h"
 #include "Vector_3D.h"
 
 namespace VCAD_lib
@@ -78,155 +79,6 @@ namespace VCAD_lib
         sort(segments.begin(), segments.end(), Segment_Sort());
     }
     
-    void Simplify_Mesh_3D::Pt_Remover::Segments::find_pts_to_remove(vector<int>& internal_pts, 
-            vector<int>& perimeter_pts, vector<Facet>& same_plane_facets, const Mesh_3D& mesh) const
-    {
-        vector<Segment> internal_segs;
-        vector<Segment> perimeter_segs;
-        vector<int> all_perimeter_pts;
-        // locate perimeter segment points and internal segments
-        for (vector<Segment>::const_iterator it = segments.begin(); it != segments.end(); ++it)
-        {
-            if (internal_segs.end() != find(internal_segs.begin(), internal_segs.end(), *it))
-                continue; // already processed internal segment, so move to next segment
-            if (segments.end() == find(it + 1, segments.end(), *it))
-            {
-                // external segment because it is only found once
-                if (all_perimeter_pts.end() == find(all_perimeter_pts.begin(), all_perimeter_pts.end(), it->point1))
-                    all_perimeter_pts.push_back(it->point1);
-                if (all_perimeter_pts.end() == find(all_perimeter_pts.begin(), all_perimeter_pts.end(), it->point2))
-                    all_perimeter_pts.push_back(it->point2);
-                perimeter_segs.push_back(*it);
-            }
-            else // internal segment because it appears twice
-                internal_segs.push_back(*it);
-        }
-        
-        // locate internal points that can be removed
-        for (vector<Segment>::const_iterator it = internal_segs.begin(); it != internal_segs.end(); ++it)
-        {
-            if ((internal_pts.end() == find(internal_pts.begin(), internal_pts.end(), it->point1)) && 
-                    (all_perimeter_pts.end() == find(all_perimeter_pts.begin(), all_perimeter_pts.end(), it->point1)))
-                internal_pts.push_back(it->point1); // point is internal and can be removed
-            if ((internal_pts.end() == find(internal_pts.begin(), internal_pts.end(), it->point2)) && 
-                    (all_perimeter_pts.end() == find(all_perimeter_pts.begin(), all_perimeter_pts.end(), it->point2)))
-                internal_pts.push_back(it->point2); // point is internal and can be removed
-        }
-        
-        class Seg_Pt_Find {
-        public:
-            Seg_Pt_Find(int pt_index) : index(pt_index) {}
-            const bool operator()(const Simplify_Mesh_3D::Pt_Remover::Segment& seg) const
-            {
-                return (seg.point1 == index) || (seg.point2 == index);
-            }
-        private:
-            const int index;
-        };
-        
-        // check if a continuous path around the perimeter pt can be formed
-        // if so, then it is a valid point that might be removed
-        // if not, then don't add it
-        // locate external points that might be able to be removed
-        for (vector<int>::const_iterator it = all_perimeter_pts.begin(); it != all_perimeter_pts.end(); ++it)
-        {
-            // find two perimeter segments that share the same point
-            Seg_Pt_Find seg_pt_find(*it);
-            vector<Segment>::const_iterator seg_it1 = find_if(perimeter_segs.cbegin(), perimeter_segs.cend(), seg_pt_find);
-            if (seg_it1 == perimeter_segs.cend())
-                continue;
-            vector<Segment>::const_iterator seg_it2 = find_if((seg_it1 + 1), perimeter_segs.cend(), seg_pt_find);
-            if (seg_it2 == perimeter_segs.cend())
-                continue;
-            
-            // test if segments are in a straight line
-            
-            int common_index = seg_it1->shares_pt(*seg_it2);
-            if (common_index == -1)
-                continue;
-            Mesh_3D::const_point_iterator pt_iter(mesh.point_begin());
-            advance(pt_iter, common_index);
-            shared_ptr<Point_3D> p2(*pt_iter);
-            pt_iter = mesh.point_begin();
-            advance(pt_iter, (common_index == seg_it1->point1) ? seg_it1->point2 : seg_it1->point1);
-            shared_ptr<Point_3D> p1(*pt_iter);
-            pt_iter = mesh.point_begin();
-            advance(pt_iter, (common_index == seg_it2->point1) ? seg_it2->point2 : seg_it2->point1);
-            shared_ptr<Point_3D> p3(*pt_iter);
-            
-            bool same_direction(false);
-            if (is_same_line(*p1, *p2, *p2, *p3, same_direction, mesh.get_precision()))
-            {
-                // check if the segments surrounding this point are on the same plane
-                vector<Segment> segs;
-                int starting_pt(-1);
-                int ending_pt(-1);
-                for (vector<Facet>::const_iterator sp_it = same_plane_facets.begin(); sp_it != same_plane_facets.end(); ++sp_it)
-                {
-                    if (sp_it->get_p1_index() == common_index)
-                    {
-                        Segment seg1(sp_it->get_p1_index(), sp_it->get_p2_index(), false);
-                        Segment seg2(sp_it->get_p1_index(), sp_it->get_p3_index(), false);
-                        if (seg1 == *seg_it1)
-                            starting_pt = sp_it->get_p3_index();
-                        else if (seg1 == *seg_it2)
-                            ending_pt = sp_it->get_p3_index();
-                        else if (seg2 == *seg_it1)
-                            starting_pt = sp_it->get_p2_index();
-                        else if (seg2 == *seg_it2)
-                            ending_pt = sp_it->get_p2_index();
-                        else
-                            segs.push_back(Segment(sp_it->get_p2_index(), sp_it->get_p3_index(), false));
-                    }
-                    else if (sp_it->get_p2_index() == common_index)
-                    {
-                        Segment seg1(sp_it->get_p2_index(), sp_it->get_p1_index(), false);
-                        Segment seg2(sp_it->get_p2_index(), sp_it->get_p3_index(), false);
-                        if (seg1 == *seg_it1)
-                            starting_pt = sp_it->get_p3_index();
-                        else if (seg1 == *seg_it2)
-                            ending_pt = sp_it->get_p3_index();
-                        else if (seg2 == *seg_it1)
-                            starting_pt = sp_it->get_p1_index();
-                        else if (seg2 == *seg_it2)
-                            ending_pt = sp_it->get_p1_index();
-                        else
-                            segs.push_back(Segment(sp_it->get_p1_index(), sp_it->get_p3_index(), false));
-                    }
-                    else if (sp_it->get_p3_index() == common_index)
-                    {
-                        Segment seg1(sp_it->get_p3_index(), sp_it->get_p1_index(), false);
-                        Segment seg2(sp_it->get_p3_index(), sp_it->get_p2_index(), false);
-                        if (seg1 == *seg_it1)
-                            starting_pt = sp_it->get_p2_index();
-                        else if (seg1 == *seg_it2)
-                            ending_pt = sp_it->get_p2_index();
-                        else if (seg2 == *seg_it1)
-                            starting_pt = sp_it->get_p1_index();
-                        else if (seg2 == *seg_it2)
-                            ending_pt = sp_it->get_p1_index();
-                        else
-                            segs.push_back(Segment(sp_it->get_p1_index(), sp_it->get_p2_index(), false));
-                    }
-                }
-                
-                // start with starting point and go around
-                vector<Segment>::const_iterator pp_iter = segs.begin();
-                while ((pp_iter = find_if(segs.begin(), segs.end(), Seg_Pt_Find(starting_pt))) != segs.end())
-                {
-                    if (starting_pt == pp_iter->point1)
-                        starting_pt = pp_iter->point2;
-                    else
-                        starting_pt = pp_iter->point1;
-                    segs.erase(pp_iter);
-                }
-                
-                if (starting_pt == ending_pt) // found path.  this point might be able to be removed
-                    perimeter_pts.push_back(*it);
-            }
-        }
-    }
-    
     const Simplify_Mesh_3D::Pt_Remover::Segment* Simplify_Mesh_3D::Pt_Remover::Segments::get_next_segment(
             const Simplify_Mesh_3D::Pt_Remover::Segment* prev_segment) const
     {
@@ -312,18 +164,18 @@ namespace VCAD_lib
                 advance(pt_it, index);
                 if (pt_it >= pt_end)
                     throw runtime_error("Invalid point index");
-                shared_ptr<Point_3D> p1(*pt_it);
+                shared_ptr<const Point_3D> p1(*pt_it);
                 pt_it = pt_begin;
                 advance(pt_it, shared_point);
                 if (pt_it >= pt_end)
                     throw runtime_error("Invalid point index");
-                shared_ptr<Point_3D> p2(*pt_it);
+                shared_ptr<const Point_3D> p2(*pt_it);
                 index = (it->point1 == shared_point) ? it->point2 : it->point1;
                 pt_it = pt_begin;
                 advance(pt_it, index);
                 if (pt_it >= pt_end)
                     throw runtime_error("Invalid point index");
-                shared_ptr<Point_3D> p3(*pt_it);
+                shared_ptr<const Point_3D> p3(*pt_it);
 
                 bool same_direction(false);
                 if (is_same_line(*p1, *p2, *p2, *p3, same_direction, precision))
@@ -378,14 +230,14 @@ namespace VCAD_lib
         advance(pt_it, p1);
         if (pt_it >= pt_end)
             throw runtime_error("invalid point index");
-        shared_ptr<Point_3D> p1_pt(*pt_it);
+        shared_ptr<const Point_3D> p1_pt(*pt_it);
         
         // get segment p2 point value
         pt_it = pt_begin;
         advance(pt_it, p2);
         if (pt_it >= pt_end)
             throw runtime_error("invalid point index");
-        shared_ptr<Point_3D> p2_pt(*pt_it);
+        shared_ptr<const Point_3D> p2_pt(*pt_it);
         
 #ifdef DEBUG_SIMPLIFY_MESH_3D_NEW_FACETS
         cout << "Simplify_Mesh_3D::Pt_Remover::Segments::is_seg_valid checking segment (" << 
@@ -401,12 +253,12 @@ namespace VCAD_lib
             advance(pt_it, it->point1);
             if (pt_it >= pt_end)
                 throw runtime_error("invalid point index");
-            shared_ptr<Point_3D> seg_p1(*pt_it);
+            shared_ptr<const Point_3D> seg_p1(*pt_it);
             pt_it = pt_begin;
             advance(pt_it, it->point2);
             if (pt_it >= pt_end)
                 throw runtime_error("invalid point index");
-            shared_ptr<Point_3D> seg_p2(*pt_it);
+            shared_ptr<const Point_3D> seg_p2(*pt_it);
             
 #ifdef DEBUG_SIMPLIFY_MESH_3D_NEW_FACETS
             cout << "Simplify_Mesh_3D::Pt_Remover::Segments::is_seg_valid testing against existing segment (" << 
@@ -473,12 +325,12 @@ namespace VCAD_lib
             advance(pt_it, it->point1);
             if (pt_it >= pt_end)
                 throw runtime_error("invalid point index");
-            shared_ptr<Point_3D> seg_p1(*pt_it);
+            shared_ptr<const Point_3D> seg_p1(*pt_it);
             pt_it = pt_begin;
             advance(pt_it, it->point2);
             if (pt_it >= pt_end)
                 throw runtime_error("invalid point index");
-            shared_ptr<Point_3D> seg_p2(*pt_it);
+            shared_ptr<const Point_3D> seg_p2(*pt_it);
             
 #ifdef DEBUG_SIMPLIFY_MESH_3D_NEW_FACETS
             cout << "Simplify_Mesh_3D::Pt_Remover::Segments::is_seg_valid testing against removed segment (" << 
@@ -675,14 +527,113 @@ namespace VCAD_lib
         //       a perimeter point can only be removed if it is found on the edge
         //       of two planes.  If more than two planes, then the point should
         //       remain in the mesh.
-        Segments segments(mesh);
-        for (vector<Facet>::const_iterator it = same_plane_facets.begin(); it != same_plane_facets.end(); ++it)
+        find_pts_to_remove(mesh);
+    }
+    
+    void Simplify_Mesh_3D::Pt_Remover::find_pts_to_remove(const Mesh_3D& mesh)
+    {
+        // a segment belonging to only one facet is a perimeter segment and
+        // a point is a perimeter point if it is on a perimeter segment
+        const Half_Edge_Mesh topology(same_plane_facets);
+        
+        class Seg_Pt_Find {
+        public:
+            Seg_Pt_Find(int pt_index) : index(pt_index) {}
+            const bool operator()(const Simplify_Mesh_3D::Pt_Remover::Segment& seg) const
+            {
+                return (seg.point1 == index) || (seg.point2 == index);
+            }
+        private:
+            const int index;
+        };
+        
+        // go through the points in the order they are first used by the facets
+        vector<bool> processed(topology.point_size(), false);
+        for (int pt_h = 0; pt_h < static_cast<int>(topology.half_edge_size()); ++pt_h)
         {
-            segments.push_back(it->get_p1_index(), it->get_p2_index(), false);
-            segments.push_back(it->get_p1_index(), it->get_p3_index(), false);
-            segments.push_back(it->get_p2_index(), it->get_p3_index(), false);
+            const int common_index(topology.point1(pt_h));
+            if (processed[common_index])
+                continue;
+            processed[common_index] = true;
+            
+            // find the first two perimeter segments that share the point
+            vector<int> perimeter_ends;
+            for (int h = topology.point_half_edge(common_index); h != -1; h = topology.next_around_point(h))
+            {
+                if (topology.is_boundary(h))
+                    perimeter_ends.push_back(topology.point2(h));
+                if (topology.is_boundary(topology.prev(h)))
+                    perimeter_ends.push_back(topology.point1(topology.prev(h)));
+            }
+            if (perimeter_ends.empty())
+            {
+                internal_pts.push_back(common_index); // point is internal and can be removed
+                continue;
+            }
+            
+            // check if a continuous path around the perimeter pt can be formed
+            // if so, then it is a valid point that might be removed
+            // if not, then don't add it
+            if (perimeter_ends.size() < 2)
+                continue;
+            
+            // test if segments are in a straight line
+            const Segment seg1(common_index, perimeter_ends[0], false);
+            const Segment seg2(common_index, perimeter_ends[1], false);
+            Mesh_3D::const_point_iterator pt_begin(mesh.point_begin());
+            shared_ptr<const Point_3D> p1(pt_begin[perimeter_ends[0]]);
+            shared_ptr<const Point_3D> p2(pt_begin[common_index]);
+            shared_ptr<const Point_3D> p3(pt_begin[perimeter_ends[1]]);
+            
+            bool same_direction(false);
+            if (is_same_line(*p1, *p2, *p2, *p3, same_direction, mesh.get_precision()))
+            {
+                // check if the segments surrounding this point are on the same plane
+                vector<Segment> segs;
+                int starting_pt(-1);
+                int ending_pt(-1);
+                int prev_facet(-1);
+                for (int h = topology.point_half_edge(common_index); h != -1; h = topology.next_around_point(h))
+                {
+                    // a facet using the point more than once is only checked once
+                    if (topology.facet(h) == prev_facet)
+                        continue;
+                    prev_facet = topology.facet(h);
+                    
+                    // the other two facet points in facet order
+                    const int next_pt(topology.point2(h));
+                    const int prev_pt(topology.point1(topology.prev(h)));
+                    const int other1(h % 3 == 1 ? prev_pt : next_pt);
+                    const int other2(h % 3 == 1 ? next_pt : prev_pt);
+                    Segment facet_seg1(common_index, other1, false);
+                    Segment facet_seg2(common_index, other2, false);
+                    if (facet_seg1 == seg1)
+                        starting_pt = other2;
+                    else if (facet_seg1 == seg2)
+                        ending_pt = other2;
+                    else if (facet_seg2 == seg1)
+                        starting_pt = other1;
+                    else if (facet_seg2 == seg2)
+                        ending_pt = other1;
+                    else
+                        segs.push_back(Segment(other1, other2, false));
+                }
+                
+                // start with starting point and go around
+                vector<Segment>::const_iterator pp_iter = segs.begin();
+                while ((pp_iter = find_if(segs.begin(), segs.end(), Seg_Pt_Find(starting_pt))) != segs.end())
+                {
+                    if (starting_pt == pp_iter->point1)
+                        starting_pt = pp_iter->point2;
+                    else
+                        starting_pt = pp_iter->point1;
+                    segs.erase(pp_iter);
+                }
+                
+                if (starting_pt == ending_pt) // found path.  this point might be able to be removed
+                    perimeter_pts.push_back(common_index);
+            }
         }
-        segments.find_pts_to_remove(internal_pts, perimeter_pts, same_plane_facets, mesh);
     }
     
     void Simplify_Mesh_3D::Pt_Remover::form_new_facets(const vector<Facet_3D>& orig_facets, 
@@ -695,10 +646,10 @@ namespace VCAD_lib
         {
             Mesh_3D::const_point_iterator pt_it = orig_mesh->point_begin();
             advance(pt_it, it->point1);
-            shared_ptr<Point_3D> p1(*pt_it);
+            shared_ptr<const Point_3D> p1(*pt_it);
             pt_it = orig_mesh->point_begin();
             advance(pt_it, it->point2);
-            shared_ptr<Point_3D> p2(*pt_it);
+            shared_ptr<const Point_3D> p2(*pt_it);
             cout << "Simplify_Mesh_3D::Pt_Remover::form_new_facets (" << it->point1 << 
                     ", " << it->point2 << ") p1 x: " << p1->get_x() << " y: " << p1->get_y() << 
                     " z: " << p1->get_z() << " p2 x: " << p2->get_x() << " y: " << p2->get_y() << 
@@ -738,13 +689,13 @@ namespace VCAD_lib
                     // verify if facet unit normal is pointing in the right direction
                     Mesh_3D::const_point_iterator pt_it = orig_mesh->point_begin();
                     advance(pt_it, seg3_p1);
-                    shared_ptr<Point_3D> p1(*pt_it);
+                    shared_ptr<const Point_3D> p1(*pt_it);
                     pt_it = orig_mesh->point_begin();
                     advance(pt_it, shared_pt);
-                    shared_ptr<Point_3D> p2(*pt_it);
+                    shared_ptr<const Point_3D> p2(*pt_it);
                     pt_it = orig_mesh->point_begin();
                     advance(pt_it, seg3_p2);
-                    shared_ptr<Point_3D> p3(*pt_it);
+                    shared_ptr<const Point_3D> p3(*pt_it);
                     Vector_3D unv(cross_product(Vector_3D(*p1, *p2), Vector_3D(*p1, *p3)));
                     if (dot_product(unv, plane_unv) < 0) // change facet point order
                         facet.invert_unv();
@@ -813,9 +764,9 @@ namespace VCAD_lib
                     cout << "Simplify_Mesh_3D::Pt_Remover::rem_internal_pts adding facet p1: " << f_it->get_p1_index() << " p2: " << f_it->get_p2_index() << " p3: " << f_it->get_p3_index() << "\n";
 #endif
                     orig_facets.push_back(*f_it);
-                    shared_ptr<Point_3D> p1(*(orig_mesh->point_begin() + f_it->get_p1_index()));
-                    shared_ptr<Point_3D> p2(*(orig_mesh->point_begin() + f_it->get_p2_index()));
-                    shared_ptr<Point_3D> p3(*(orig_mesh->point_begin() + f_it->get_p3_index()));
+                    shared_ptr<Point_3D> p1(new Point_3D(**(orig_mesh->point_begin() + f_it->get_p1_index())));
+                    shared_ptr<Point_3D> p2(new Point_3D(**(orig_mesh->point_begin() + f_it->get_p2_index())));
+                    shared_ptr<Point_3D> p3(new Point_3D(**(orig_mesh->point_begin() + f_it->get_p3_index())));
                     orig_facet_3ds.push_back(Facet_3D(p1, p2, p3));
                     f_it = same_plane_facets.erase(f_it);
                 }
@@ -879,9 +830,9 @@ namespace VCAD_lib
                 cout << "Simplify_Mesh_3D::Pt_Remover::rem_perimeter_pt adding facet p1: " << f_it->get_p1_index() << " p2: " << f_it->get_p2_index() << " p3: " << f_it->get_p3_index() << "\n";
 #endif
                 orig_facets.push_back(*f_it);
-                shared_ptr<Point_3D> p1(*(orig_mesh->point_begin() + f_it->get_p1_index()));
-                shared_ptr<Point_3D> p2(*(orig_mesh->point_begin() + f_it->get_p2_index()));
-                shared_ptr<Point_3D> p3(*(orig_mesh->point_begin() + f_it->get_p3_index()));
+                shared_ptr<Point_3D> p1(new Point_3D(**(orig_mesh->point_begin() + f_it->get_p1_index())));
+                shared_ptr<Point_3D> p2(new Point_3D(**(orig_mesh->point_begin() + f_it->get_p2_index())));
+                shared_ptr<Point_3D> p3(new Point_3D(**(orig_mesh->point_begin() + f_it->get_p3_index())));
                 orig_facet_3ds.push_back(Facet_3D(p1, p2, p3));
                 f_it = same_plane_facets.erase(f_it);
             }
@@ -955,7 +906,7 @@ namespace VCAD_lib
         same_plane_facets.push_back(*facet_it); 
         facet_list.erase(facet_it);
 
-        shared_ptr<Point_3D> fp1(*(mesh.point_begin() + facet_it->get_p1_index()));
+        shared_ptr<const Point_3D> fp1(*(mesh.point_begin() + facet_it->get_p1_index()));
         // now iterate through mesh and get all facets with the same unv
         vector<Facet>::const_iterator it = facet_list.begin();
         while (it != facet_list.end())
@@ -1138,13 +1089,13 @@ namespace VCAD_lib
 #endif
                 Mesh_3D::const_point_iterator pt_it(mesh.point_begin());
                 advance(pt_it, pr_it->get_p1_index());
-                shared_ptr<Point_3D> p1(*pt_it);
+                shared_ptr<Point_3D> p1(new Point_3D(**pt_it));
                 pt_it = mesh.point_begin();
                 advance(pt_it, pr_it->get_p2_index());
-                shared_ptr<Point_3D> p2(*pt_it);
+                shared_ptr<Point_3D> p2(new Point_3D(**pt_it));
                 pt_it = mesh.point_begin();
                 advance(pt_it, pr_it->get_p3_index());
-                shared_ptr<Point_3D> p3(*pt_it);
+                shared_ptr<Point_3D> p3(new Point_3D(**pt_it));
                 temp_mesh.push_back(Facet_3D(p1, p2, p3));
             }
         }
@@ -67,12 +67,6 @@ namespace VCAD_lib
                  * add a segment
                  */
                 void push_back(const int p1, const int p2, const bool internal);
-                /*
-                 * sort segments to locate internal and perimeter points that might
-                 * be able to be removed
-                 */
-                void find_pts_to_remove(vector<int>& internal_pts, vector<int>& perimeter_pts, 
-                        vector<Facet>& same_plane_facets, const Mesh_3D& mesh) const;
                 /*
                  * Get next segment
                  */
@@ -124,6 +118,10 @@ namespace VCAD_lib
             vector<int> internal_pts; // internal points that can be removed
             vector<int> perimeter_pts; // perimeter points that may or may not be removed
             vector<Facet> same_plane_facets;
+            /*
+             * locate internal and perimeter points that might be able to be removed
+             */
+            void find_pts_to_remove(const Mesh_3D& mesh);
             /*
              * form new facets
              */
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Transform_3D.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Transform_3D.h"
+#include <stdexcept>
+
+namespace VCAD_lib
+{
+    Transform_3D::Transform_3D()
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+                m[row][col] = row == col ? 1 : 0;
+        }
+    }
+
+    Transform_3D::Transform_3D(const Measurement m00, const Measurement m01, const Measurement m02, const Measurement m03,
+            const Measurement m10, const Measurement m11, const Measurement m12, const Measurement m13,
+            const Measurement m20, const Measurement m21, const Measurement m22, const Measurement m23)
+    {
+        m[0][0] = m00; m[0][1] = m01; m[0][2] = m02; m[0][3] = m03;
+        m[1][0] = m10; m[1][1] = m11; m[1][2] = m12; m[1][3] = m13;
+        m[2][0] = m20; m[2][1] = m21; m[2][2] = m22; m[2][3] = m23;
+    }
+
+    Transform_3D::Measurement Transform_3D::get(const int row, const int col) const
+    {
+        if (row < 0 || row > 2 || col < 0 || col > 3)
+            throw out_of_range("transform matrix index out of range");
+        return m[row][col];
+    }
+
+    Transform_3D& Transform_3D::rotate(const Angle& angle)
+    {
+        return this->rotate(angle, Point_3D(0,0,0));
+    }
+
+    Transform_3D& Transform_3D::rotate(const Angle_Meas angle, const Vector_3D& axis)
+    {
+        return this->rotate(angle, axis, Point_3D(0,0,0));
+    }
+
+    Transform_3D& Transform_3D::rotate(const Angle& angle, const Point_3D& origin)
+    {
+        if (angle.angle_x != 0)
+            this->rotate(angle.angle_x, Vector_3D(1,0,0), origin);
+
+        if (angle.angle_y != 0)
+            this->rotate(angle.angle_y, Vector_3D(0,1,0), origin);
+
+        if (angle.angle_z != 0)
+            this->rotate(angle.angle_z, Vector_3D(0,0,1), origin);
+
+        return *this;
+    }
+
+    Transform_3D& Transform_3D::rotate(const Angle_Meas angle, const Vector_3D& axis, const Point_3D& origin)
+    {
+        // a zero length axis does not rotate (see Point_3D::rotate)
+        const Measurement length(axis.length());
+        if (length == 0)
+            return *this;
+
+        // rotation matrix about a unit axis using right hand rule with thumb
+        // pointing in direction of axis (Rodrigues' rotation formula)
+        const Measurement x(axis.get_x() / length);
+        const Measurement y(axis.get_y() / length);
+        const Measurement z(axis.get_z() / length);
+        const Measurement c(cos(angle));
+        const Measurement s(sin(angle));
+        const Measurement t(1 - c);
+
+        const Measurement r00(t * x * x + c);
+        const Measurement r01(t * x * y - s * z);
+        const Measurement r02(t * x * z + s * y);
+        const Measurement r10(t * x * y + s * z);
+        const Measurement r11(t * y * y + c);
+        const Measurement r12(t * y * z - s * x);
+        const Measurement r20(t * x * z - s * y);
+        const Measurement r21(t * y * z + s * x);
+        const Measurement r22(t * z * z + c);
+
+        // rotate about origin: origin + R * (p - origin)
+        const Measurement ox(origin.get_x());
+        const Measurement oy(origin.get_y());
+        const Measurement oz(origin.get_z());
+        return this->transform(Transform_3D(
+                r00, r01, r02, ox - (r00 * ox + r01 * oy + r02 * oz),
+                r10, r11, r12, oy - (r10 * ox + r11 * oy + r12 * oz),
+                r20, r21, r22, oz - (r20 * ox + r21 * oy + r22 * oz)));
+    }
+
+    Transform_3D& Transform_3D::scale(const Measurement x_scalar, const Measurement y_scalar,
+            const Measurement z_scalar)
+    {
+        for (int col = 0; col < 4; ++col)
+        {
+            m[0][col] *= x_scalar;
+            m[1][col] *= y_scalar;
+            m[2][col] *= z_scalar;
+        }
+        return *this;
+    }
+
+    Transform_3D& Transform_3D::scale(const Measurement x_scalar, const Measurement y_scalar,
+            const Measurement z_scalar, const Point_3D& origin)
+    {
+        this->translate(-origin.get_x(), -origin.get_y(), -origin.get_z());
+        this->scale(x_scalar, y_scalar, z_scalar);
+        return this->translate(origin.get_x(), origin.get_y(), origin.get_z());
+    }
+
+    Transform_3D& Transform_3D::translate(const Measurement x_val, const Measurement y_val,
+            const Measurement z_val)
+    {
+        m[0][3] += x_val;
+        m[1][3] += y_val;
+        m[2][3] += z_val;
+        return *this;
+    }
+
+    Transform_3D& Transform_3D::translate(const Vector_3D& v)
+    {
+        return this->translate(v.get_x(), v.get_y(), v.get_z());
+    }
+
+    Transform_3D& Transform_3D::move_x_pxy(const Point_3D& new_origin, const Vector_3D& x_axis,
+            const Point_3D& pt_xy_plane, const Point_3D& ref_origin)
+    {
+        // determine y_axis by using pt_xy_plane point
+        Vector_3D y_axis(new_origin, pt_xy_plane);
+        y_axis -= orthogonal_projection(y_axis, x_axis);
+
+        return move(new_origin, x_axis, y_axis, cross_product(x_axis, y_axis), ref_origin);
+    }
+
+    Transform_3D& Transform_3D::move_x_pxz(const Point_3D& new_origin, const Vector_3D& x_axis,
+            const Point_3D& pt_xz_plane, const Point_3D& ref_origin)
+    {
+        // determine z_axis by using pt_xz_plane point
+        Vector_3D z_axis(new_origin, pt_xz_plane);
+        z_axis -= orthogonal_projection(z_axis, x_axis);
+
+        return move(new_origin, x_axis, cross_product(z_axis, x_axis), z_axis, ref_origin);
+    }
+
+    Transform_3D& Transform_3D::move_y_pxy(const Point_3D& new_origin, const Vector_3D& y_axis,
+            const Point_3D& pt_xy_plane, const Point_3D& ref_origin)
+    {
+        // determine x_axis by using pt_xy_plane point
+        Vector_3D x_axis(new_origin, pt_xy_plane);
+        x_axis -= orthogonal_projection(x_axis, y_axis);
+
+        return move(new_origin, x_axis, y_axis, cross_product(x_axis, y_axis), ref_origin);
+    }
+
+    Transform_3D& Transform_3D::move_y_pyz(const Point_3D& new_origin, const Vector_3D& y_axis,
+            const Point_3D& pt_yz_plane, const Point_3D& ref_origin)
+    {
+        // determine z_axis by using pt_yz_plane point
+        Vector_3D z_axis(new_origin, pt_yz_plane);
+        z_axis -= orthogonal_projection(z_axis, y_axis);
+
+        return move(new_origin, cross_product(y_axis, z_axis), y_axis, z_axis, ref_origin);
+    }
+
+    Transform_3D& Transform_3D::move_z_pxz(const Point_3D& new_origin, const Vector_3D& z_axis,
+            const Point_3D& pt_xz_plane, const Point_3D& ref_origin)
+    {
+        // determine x_axis by using pt_xz_plane point
+        Vector_3D x_axis(new_origin, pt_xz_plane);
+        x_axis -= orthogonal_projection(x_axis, z_axis);
+
+        return move(new_origin, x_axis, cross_product(z_axis, x_axis), z_axis, ref_origin);
+    }
+
+    Transform_3D& Transform_3D::move_z_pyz(const Point_3D& new_origin, const Vector_3D& z_axis,
+            const Point_3D& pt_yz_plane, const Point_3D& ref_origin)
+    {
+        // determine y_axis by using pt_yz_plane point
+        Vector_3D y_axis(new_origin, pt_yz_plane);
+        y_axis -= orthogonal_projection(y_axis, z_axis);
+
+        return move(new_origin, cross_product(y_axis, z_axis), y_axis, z_axis, ref_origin);
+    }
+
+    Transform_3D& Transform_3D::move(const Point_3D& new_origin, const Vector_3D& new_x_axis,
+            const Vector_3D& new_y_axis, const Vector_3D& new_z_axis,
+            const Point_3D& ref_origin)
+    {
+        // new point is new_origin + x * x_axis + y * y_axis + z * z_axis where
+        // x, y, and z are relative to ref_origin
+        Vector_3D x_axis(new_x_axis);
+        x_axis.normalize();
+        Vector_3D y_axis(new_y_axis);
+        y_axis.normalize();
+        Vector_3D z_axis(new_z_axis);
+        z_axis.normalize();
+
+        Transform_3D t(x_axis.get_x(), y_axis.get_x(), z_axis.get_x(), new_origin.get_x(),
+                x_axis.get_y(), y_axis.get_y(), z_axis.get_y(), new_origin.get_y(),
+                x_axis.get_z(), y_axis.get_z(), z_axis.get_z(), new_origin.get_z());
+        this->translate(-ref_origin.get_x(), -ref_origin.get_y(), -ref_origin.get_z());
+        return this->transform(t);
+    }
+
+    Transform_3D& Transform_3D::transform(const Transform_3D& t)
+    {
+        *this = t * *this;
+        return *this;
+    }
+
+    const Transform_3D operator*(const Transform_3D& t1, const Transform_3D& t2)
+    {
+        Transform_3D::Measurement r[3][4];
+        for (int row = 0; row < 3; ++row)
+        {
+            for (int col = 0; col < 4; ++col)
+            {
+                r[row][col] = t1.get(row, 0) * t2.get(0, col) + t1.get(row, 1) * t2.get(1, col) +
+                        t1.get(row, 2) * t2.get(2, col);
+            }
+            r[row][3] += t1.get(row, 3);
+        }
+        return Transform_3D(r[0][0], r[0][1], r[0][2], r[0][3],
+                r[1][0], r[1][1], r[1][2], r[1][3],
+                r[2][0], r[2][1], r[2][2], r[2][3]);
+    }
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Transform_3D.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef TRANSFORM_3D_H
+#define TRANSFORM_3D_H
+
+#include "Point_3D.h"
+#include "Vector_3D.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+
+    /*
+     * Affine transform stored as a 3x4 matrix.  A point p is transformed to
+     * M * p + t where M is the first three columns and t is the last column.
+     *
+     * The rotate, scale, translate, and move methods work the same as the
+     * Point_3D methods with the same names, except they add the operation to
+     * the transform instead of changing a point.  Each operation is done after
+     * the operations already in the transform, so
+     *
+     *     Transform_3D().rotate(angle).scale(2,2,2).translate(v)
+     *
+     * rotates, then scales, then translates.  Applying the result to all of the
+     * points of a mesh is one pass over the points no matter how many
+     * operations were added.
+     */
+    class Transform_3D {
+    public:
+        typedef Point_3D::Measurement Measurement;
+        typedef Point_3D::Angle_Meas Angle_Meas;
+        // identity transform
+        // exception safety: no throw
+        Transform_3D();
+        // matrix values by row
+        // exception safety: no throw
+        Transform_3D(const Measurement m00, const Measurement m01, const Measurement m02, const Measurement m03,
+                const Measurement m10, const Measurement m11, const Measurement m12, const Measurement m13,
+                const Measurement m20, const Measurement m21, const Measurement m22, const Measurement m23);
+        // exception safety: strong guarantee - out_of_range if row > 2 or col > 3
+        Measurement get(const int row, const int col) const;
+        // rotate
+        // exception safety: no throw
+        Transform_3D& rotate(const Angle& angle);
+        // exception safety: no throw
+        Transform_3D& rotate(const Angle_Meas angle, const Vector_3D& axis);
+        // exception safety: no throw
+        Transform_3D& rotate(const Angle& angle, const Point_3D& origin);
+        // exception safety: no throw
+        Transform_3D& rotate(const Angle_Meas angle, const Vector_3D& axis, const Point_3D& origin);
+        // scale
+        // exception safety: no throw
+        Transform_3D& scale(const Measurement x_scalar, const Measurement y_scalar,
+                const Measurement z_scalar);
+        // exception safety: no throw
+        Transform_3D& scale(const Measurement x_scalar, const Measurement y_scalar,
+                const Measurement z_scalar, const Point_3D& origin);
+        // translate
+        // exception safety: no throw
+        Transform_3D& translate(const Measurement x_val, const Measurement y_val,
+                const Measurement z_val);
+        // exception safety: no throw
+        Transform_3D& translate(const Vector_3D& v);
+        /*
+         * move to a different coordinate system and origin.  See Point_3D.
+         *
+         * exception safety: strong guarantee - length_error if an axis has zero length
+         */
+        Transform_3D& move_x_pxy(const Point_3D& new_origin,
+                const Vector_3D& x_axis, const Point_3D& pt_xy_plane,
+                const Point_3D& ref_origin=Point_3D(0,0,0));
+        Transform_3D& move_x_pxz(const Point_3D& new_origin,
+                const Vector_3D& x_axis, const Point_3D& pt_xz_plane,
+                const Point_3D& ref_origin=Point_3D(0,0,0));
+        Transform_3D& move_y_pxy(const Point_3D& new_origin,
+                const Vector_3D& y_axis, const Point_3D& pt_xy_plane,
+                const Point_3D& ref_origin=Point_3D(0,0,0));
+        Transform_3D& move_y_pyz(const Point_3D& new_origin,
+                const Vector_3D& y_axis, const Point_3D& pt_yz_plane,
+                const Point_3D& ref_origin=Point_3D(0,0,0));
+        Transform_3D& move_z_pxz(const Point_3D& new_origin,
+                const Vector_3D& z_axis, const Point_3D& pt_xz_plane,
+                const Point_3D& ref_origin=Point_3D(0,0,0));
+        Transform_3D& move_z_pyz(const Point_3D& new_origin,
+                const Vector_3D& z_axis, const Point_3D& pt_yz_plane,
+                const Point_3D& ref_origin=Point_3D(0,0,0));
+        // do transform t after this transform
+        // exception safety: no throw
+        Transform_3D& transform(const Transform_3D& t);
+        // apply the transform to a point
+        // exception safety: no throw
+        const Point_3D apply(const Point_3D& pt) const
+        {
+            const Measurement x(pt.get_x());
+            const Measurement y(pt.get_y());
+            const Measurement z(pt.get_z());
+            return Point_3D(m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3],
+                    m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3],
+                    m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3]);
+        }
+        // apply the transform to a vector (the translation is not used)
+        // exception safety: no throw
+        const Vector_3D apply(const Vector_3D& v) const
+        {
+            return Vector_3D(m[0][0] * v.get_x() + m[0][1] * v.get_y() + m[0][2] * v.get_z(),
+                    m[1][0] * v.get_x() + m[1][1] * v.get_y() + m[1][2] * v.get_z(),
+                    m[2][0] * v.get_x() + m[2][1] * v.get_y() + m[2][2] * v.get_z());
+        }
+    private:
+        Measurement m[3][4];
+
+        // new_x_axis, new_y_axis, and new_z_axis are the columns before normalizing
+        Transform_3D& move(const Point_3D& new_origin, const Vector_3D& new_x_axis,
+                const Vector_3D& new_y_axis, const Vector_3D& new_z_axis,
+                const Point_3D& ref_origin);
+    };
+
+    // the transform that does t2 and then t1
+    // exception safety: no throw
+    const Transform_3D operator*(const Transform_3D& t1, const Transform_3D& t2);
+}
+
+#endif /* TRANSFORM_3D_H */
+
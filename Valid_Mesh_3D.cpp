@@ -20,26 +20,16 @@
 #include "Valid_Mesh_3D.h"
 
 #include <algorithm>
+#include <cmath>
 #include <functional>
-#include <unordered_set>
 #include <utility>
+#include "Half_Edge_Mesh.h"
 #include "Mesh_3D.h"
+#include "Point_Grid_3D.h"
 
 namespace VCAD_lib
 {
 
-    Valid_Mesh_3D::Facet_Side::Facet_Side(const int p1, const int p2) : point1(p1), point2(p2) {}
-    
-    const bool Valid_Mesh_3D::Facet_Side::operator ==(const Facet_Side& side) const
-    {
-        return (point1 == side.point1 || point1 == side.point2) && (point2 == side.point2 || point2 == side.point1);
-    }
-    
-    const int Valid_Mesh_3D::FS_Hasher::operator ()(const Facet_Side& side) const
-    {
-        return side.point1 ^ side.point2;
-    }
-    
     const int Valid_Mesh_3D::Facet_3D_Hasher::operator ()(const Facet_3D& facet) const
     {
         hash<Point_3D::Measurement> hasher;
@@ -60,15 +50,6 @@ namespace VCAD_lib
                 (facet1.get_point3() == facet2.get_point3());
     }
     
-    Valid_Mesh_3D::Facet_Find::Facet_Find(const Facet_3D& f) : facet(f) {}
-    
-    const bool Valid_Mesh_3D::Facet_Find::operator ()(const Facet_3D& f) const
-    {
-        return f.get_point1() == facet.get_point1() && 
-                f.get_point2() == facet.get_point2() && 
-                f.get_point3() == facet.get_point3();
-    }
-    
     const Vector_3D::Measurement Valid_Mesh_3D::Facet_Sorter::area(const Facet_3D& f) const
     {
         Vector_3D p1p2(*f.get_point1(), *f.get_point2());
@@ -129,9 +110,10 @@ namespace VCAD_lib
             all_points(), all_facets(), facets_inside_facets(),
             pts_on_facet_sides(), edge_facets(), too_many_share_side() 
     {
+        // copy the points so the facets handed out can not change the mesh
         for (Mesh_3D::const_point_iterator it = mesh.point_begin(); it != mesh.point_end(); ++it)
         {
-            all_points.push_back(*it);
+            all_points.push_back(shared_ptr<Point_3D>(new Point_3D(**it)));
         }
         for (Mesh_3D::const_facet_iterator it = mesh.facet_begin(); it != mesh.facet_end(); ++it)
         {
@@ -139,158 +121,166 @@ namespace VCAD_lib
         }
     }
 
+    const Point_3D::Measurement Valid_Mesh_3D::scaled_precision() const
+    {
+        Point_3D::Measurement largest(1);
+        for (vector<shared_ptr<Point_3D>>::const_iterator it = all_points.begin(); it != all_points.end(); ++it)
+            largest = max(largest, max(fabs((*it)->get_x()), max(fabs((*it)->get_y()), fabs((*it)->get_z()))));
+        return 2 * largest * precision;
+    }
+    
     void Valid_Mesh_3D::find_same_plane_facets(vector<vector<Facet_3D>>& sp_facets) const
     {
         vector<Facet_3D> facets;
+        facets.reserve(all_facets.size());
         for (vector<Facet>::const_iterator it = all_facets.begin(); it != all_facets.end(); ++it)
+            facets.push_back(Facet_3D(all_points[it->get_p1_index()], all_points[it->get_p2_index()], 
+                    all_points[it->get_p3_index()]));
+        
+        // facets on the same plane have offsets that differ by no more than
+        // what is_pt_on_facet_plane allows for points of this size
+        const Point_3D::Measurement offset_precision(scaled_precision());
+        
+        // group the facets by unit normal vector using a grid of the normals
+        class Same_Normal {
+        public:
+            Same_Normal(const vector<Vector_3D>& u, const Vector_3D& v, const Point_3D::Measurement prec) : 
+                    unvs(u), unv(v), precision(prec) {}
+            const bool operator()(const int index) const { return is_equal(unvs[index], unv, precision); }
+        private:
+            const vector<Vector_3D>& unvs;
+            const Vector_3D& unv;
+            const Point_3D::Measurement precision;
+        };
+        Point_Grid_3D normal_grid(precision);
+        vector<Vector_3D> group_unvs;
+        vector<vector<pair<Point_3D::Measurement,int>>> groups; // plane offset and facet index
+        for (vector<Facet_3D>::size_type index = 0; index < facets.size(); ++index)
         {
-            vector<shared_ptr<Point_3D>>::const_iterator p1_it = all_points.begin();
-            vector<shared_ptr<Point_3D>>::const_iterator p2_it = all_points.begin();
-            vector<shared_ptr<Point_3D>>::const_iterator p3_it = all_points.begin();
-            advance(p1_it, it->get_p1_index());
-            advance(p2_it, it->get_p2_index());
-            advance(p3_it, it->get_p3_index());
-            
-            facets.push_back(Facet_3D(*p1_it, *p2_it, *p3_it));
+            const Vector_3D unv(facets[index].get_unv());
+            const Point_3D unv_pt(unv.get_x(), unv.get_y(), unv.get_z());
+            int group(normal_grid.find_if(unv_pt, Same_Normal(group_unvs, unv, precision)));
+            if (group == -1)
+            {
+                group = group_unvs.size();
+                group_unvs.push_back(unv);
+                groups.push_back(vector<pair<Point_3D::Measurement,int>>());
+                normal_grid.insert(unv_pt, group);
+            }
+            const Point_3D& p1(*facets[index].get_point1());
+            groups[group].push_back(pair<Point_3D::Measurement,int>(unv.get_x() * p1.get_x() + 
+                    unv.get_y() * p1.get_y() + unv.get_z() * p1.get_z(), index));
         }
-
-        vector<Facet_3D>::const_iterator it(--facets.end());
-        while (it >= facets.begin())
+        
+        // split each group into planes where the sorted offsets have a gap
+        for (vector<vector<pair<Point_3D::Measurement,int>>>::iterator it = groups.begin(); it != groups.end(); ++it)
         {
-            Facet_3D facet(*it);
-            facets.erase(it); // ignore return value
-            
+            sort(it->begin(), it->end());
             vector<Facet_3D> same_plane;
-            same_plane.push_back(facet);
-            vector<Facet_3D>::const_iterator it2(--facets.end());
-            while (it2 >= facets.begin())
+            for (vector<pair<Point_3D::Measurement,int>>::const_iterator f_it = it->begin(); f_it != it->end(); ++f_it)
             {
-                if (is_equal(it2->get_unv(), facet.get_unv(), precision))
+                if (f_it != it->begin() && f_it->first - (f_it - 1)->first > offset_precision)
                 {
-                    same_plane.push_back(*it2);
-                    it2 = facets.erase(it2);
+                    sp_facets.push_back(same_plane);
+                    same_plane.clear();
                 }
-
-                --it2;
+                same_plane.push_back(facets[f_it->second]);
             }
-
             sp_facets.push_back(same_plane);
-            it = --facets.end();
         }
     }
     
     const bool Valid_Mesh_3D::validate()
     {
-        unordered_map<Facet_Side,int,FS_Hasher> sides;
-        unordered_set<int> points;
+        // count the number of facets sharing each side
+        const Half_Edge_Mesh topology(all_facets);
         
-        // go through facets and get unique points and count the number of side occurrences
-        for (vector<Facet>::const_iterator facet_it = all_facets.begin(); facet_it != all_facets.end(); ++facet_it)
+        // go through the sides and find edge facets and sides shared by too many facets
+        vector<bool> is_edge_facet(topology.facet_size(), false);
+        for (int e = 0; e < static_cast<int>(topology.edge_size()); ++e)
         {
-            points.insert(facet_it->get_p1_index());
-            points.insert(facet_it->get_p2_index());
-            points.insert(facet_it->get_p3_index());
-            
-            // take each side of each facet and insert into the map of sides
-            // if the side already exists, update the side count
-            // p1p2
-            Facet_Side side(facet_it->get_p1_index(), facet_it->get_p2_index());
-            unordered_map<Facet_Side,int,FS_Hasher>::iterator it = sides.find(side);
-            if (it == sides.end())
-                sides.insert(pair<Facet_Side,int>(side,1));
-            else
-                it->second = it->second + 1;
-
-            // p1p3
-            side = Facet_Side(facet_it->get_p1_index(), facet_it->get_p3_index());
-            it = sides.find(side);
-            if (it == sides.end())
-                sides.insert(pair<Facet_Side,int>(side,1));
-            else
-                it->second = it->second + 1;
-            
-            // p2p3
-            side = Facet_Side(facet_it->get_p2_index(), facet_it->get_p3_index());
-            it = sides.find(side);
-            if (it == sides.end())
-                sides.insert(pair<Facet_Side,int>(side,1));
-            else
-                it->second = it->second + 1;
-        }
-        
-        // now take each unique side and look for points that are on the side
-        // but are not end points
-        for (unordered_map<Facet_Side,int,FS_Hasher>::const_iterator side_it = sides.begin(); side_it != sides.end(); ++side_it)
-        {
-            if (side_it->second == 1)
+            const int first_h(topology.edge_half_edge(e));
+            if (topology.edge_count(e) == 1)
             {
-                for (vector<Facet>::const_iterator it = all_facets.begin(); it != all_facets.end(); ++it)
+                const int f(topology.facet(first_h));
+                if (!is_edge_facet[f])
                 {
-                    int count = 0;
-                    if (it->get_p1_index() == side_it->first.point1 || it->get_p1_index() == side_it->first.point2)
-                        ++count;
-                    if (it->get_p2_index() == side_it->first.point1 || it->get_p2_index() == side_it->first.point2)
-                        ++count;
-                    if (it->get_p3_index() == side_it->first.point1 || it->get_p3_index() == side_it->first.point2)
-                        ++count;
-                    if (count == 2)
-                    {
-                        vector<shared_ptr<Point_3D>>::const_iterator p1_it = all_points.begin();
-                        vector<shared_ptr<Point_3D>>::const_iterator p2_it = all_points.begin();
-                        vector<shared_ptr<Point_3D>>::const_iterator p3_it = all_points.begin();
-                        advance(p1_it, it->get_p1_index());
-                        advance(p2_it, it->get_p2_index());
-                        advance(p3_it, it->get_p3_index());
-                        Facet_3D edge_facet(*p1_it, *p2_it, *p3_it);
-                        if (edge_facets.end() == find_if(edge_facets.begin(), edge_facets.end(), Facet_Find(edge_facet)))
-                            edge_facets.push_back(edge_facet);
-                        break;
-                    }
+                    is_edge_facet[f] = true;
+                    const Facet& facet(all_facets[f]);
+                    edge_facets.push_back(Facet_3D(all_points[facet.get_p1_index()], 
+                            all_points[facet.get_p2_index()], all_points[facet.get_p3_index()]));
                 }
             }
-            else if (side_it->second > 2)
+            else if (topology.edge_count(e) > 2)
             {
                 vector<Facet_3D> facets;
-                for (vector<Facet>::const_iterator it = all_facets.begin(); it != all_facets.end(); ++it)
+                for (int h = first_h; h != -1; h = topology.next_on_edge(h))
                 {
-                    int count = 0;
-                    if (it->get_p1_index() == side_it->first.point1 || it->get_p1_index() == side_it->first.point2)
-                        ++count;
-                    if (it->get_p2_index() == side_it->first.point1 || it->get_p2_index() == side_it->first.point2)
-                        ++count;
-                    if (it->get_p3_index() == side_it->first.point1 || it->get_p3_index() == side_it->first.point2)
-                        ++count;
-                    if (count == 2) {
-                        vector<shared_ptr<Point_3D>>::const_iterator p1_it = all_points.begin();
-                        vector<shared_ptr<Point_3D>>::const_iterator p2_it = all_points.begin();
-                        vector<shared_ptr<Point_3D>>::const_iterator p3_it = all_points.begin();
-                        advance(p1_it, it->get_p1_index());
-                        advance(p2_it, it->get_p2_index());
-                        advance(p3_it, it->get_p3_index());
-                        facets.push_back(Facet_3D(*p1_it, *p2_it, *p3_it));
-                    }
+                    const Facet& facet(all_facets[topology.facet(h)]);
+                    facets.push_back(Facet_3D(all_points[facet.get_p1_index()], 
+                            all_points[facet.get_p2_index()], all_points[facet.get_p3_index()]));
                 }
                 
                 too_many_share_side.push_back(facets);
             }
+        }
+        
+        // now take each unique side and look for points that are on the side
+        // but are not end points.  Only the points whose x is within the 
+        // side's x range are checked, found from the used points sorted by x
+        const Point_3D::Measurement box_precision(scaled_precision());
+        class X_Less {
+        public:
+            X_Less(const vector<shared_ptr<Point_3D>>& pts) : points(pts) {}
+            const bool operator()(const int pt1, const int pt2) const { return points[pt1]->get_x() < points[pt2]->get_x(); }
+            const bool operator()(const int pt, const Point_3D::Measurement x) const { return points[pt]->get_x() < x; }
+        private:
+            const vector<shared_ptr<Point_3D>>& points;
+        };
+        vector<int> x_order;
+        for (int pt = 0; pt < static_cast<int>(topology.point_size()); ++pt)
+        {
+            // skip points not used by a facet
+            if (topology.point_half_edge(pt) != -1)
+                x_order.push_back(pt);
+        }
+        sort(x_order.begin(), x_order.end(), X_Less(all_points));
+        vector<bool> is_on_side(all_points.size(), false);
+        vector<int> side_pts;
+        for (int e = 0; e < static_cast<int>(topology.edge_size()); ++e)
+        {
+            const int side_p1(topology.point1(topology.edge_half_edge(e)));
+            const int side_p2(topology.point2(topology.edge_half_edge(e)));
+            const shared_ptr<Point_3D>& p1(all_points[side_p1]);
+            const shared_ptr<Point_3D>& p2(all_points[side_p2]);
+            const Point_3D::Measurement min_y(min(p1->get_y(), p2->get_y()) - box_precision);
+            const Point_3D::Measurement max_y(max(p1->get_y(), p2->get_y()) + box_precision);
+            const Point_3D::Measurement min_z(min(p1->get_z(), p2->get_z()) - box_precision);
+            const Point_3D::Measurement max_z(max(p1->get_z(), p2->get_z()) + box_precision);
+            const Point_3D::Measurement max_x(max(p1->get_x(), p2->get_x()) + box_precision);
             
-            vector<shared_ptr<Point_3D>>::const_iterator p1_it = all_points.begin();
-            advance(p1_it, side_it->first.point1);
-
-            vector<shared_ptr<Point_3D>>::const_iterator p2_it = all_points.begin();
-            advance(p2_it, side_it->first.point2);
-            
-            for (unordered_set<int>::const_iterator it = points.begin(); it != points.end(); ++it)
+            side_pts.clear();
+            for (vector<int>::const_iterator it = lower_bound(x_order.begin(), x_order.end(), 
+                    min(p1->get_x(), p2->get_x()) - box_precision, X_Less(all_points)); 
+                    it != x_order.end() && all_points[*it]->get_x() <= max_x; ++it)
             {
-                // go to next side if point is an end point
-                if (side_it->first.point1 == *it || side_it->first.point2 == *it)
+                // go to next point if point is an end point or is outside the side's box
+                const Point_3D& point(*all_points[*it]);
+                if (side_p1 == *it || side_p2 == *it || point.get_y() < min_y || point.get_y() > max_y || 
+                        point.get_z() < min_z || point.get_z() > max_z)
                     continue;
-
-                vector<shared_ptr<Point_3D>>::const_iterator point_it = all_points.begin();
-                advance(point_it, *it);
-                
-                if (is_pt_on_vector(**point_it, **p1_it, **p2_it, precision) && pts_on_facet_sides.end() == find(pts_on_facet_sides.begin(), pts_on_facet_sides.end(), *point_it))
-                    pts_on_facet_sides.push_back(*point_it);
+                side_pts.push_back(*it);
+            }
+            // check the points in index order
+            sort(side_pts.begin(), side_pts.end());
+            for (vector<int>::const_iterator it = side_pts.begin(); it != side_pts.end(); ++it)
+            {
+                const shared_ptr<Point_3D>& point(all_points[*it]);
+                if (!is_on_side[*it] && is_pt_on_vector(*point, *p1, *p2, precision))
+                {
+                    is_on_side[*it] = true;
+                    pts_on_facet_sides.push_back(point);
+                }
             }
         }
         
@@ -43,18 +43,6 @@ namespace VCAD_lib
      */
     class Valid_Mesh_3D {
     private:
-        struct Facet_Side {
-            int point1;
-            int point2;
-            Facet_Side(const int p1, const int p2);
-            const bool operator==(const Facet_Side& side) const;
-        };
-        
-        // Facet_Side hasher
-        struct FS_Hasher {
-            const int operator()(const Facet_Side& side) const;
-        };
-        
         // Facet hasher
         struct Facet_3D_Hasher {
             const int operator()(const Facet_3D& facet) const;
@@ -64,14 +52,6 @@ namespace VCAD_lib
             const bool operator()(const Facet_3D& facet1, const Facet_3D& facet2) const;
         };
         
-        class Facet_Find {
-        public:
-            Facet_Find(const Facet_3D& f);
-            const bool operator()(const Facet_3D& f) const;
-        private:
-            const Facet_3D facet;
-        };
-        
         struct Facet_Sorter {
             const Vector_3D::Measurement area(const Facet_3D& f) const;
             const bool operator()(const Facet_3D& f1, const Facet_3D& f2) const;
@@ -112,7 +92,14 @@ namespace VCAD_lib
         // key is the facet that contains the facets in the vector value
         unordered_map<Facet_3D,vector<Facet_3D>,Facet_3D_Hasher,Facet_3D_Predicate> facets_inside_facets;
         
+        /*
+         * Put facets with the same unit normal vector and plane offset into
+         * the same list.  Facets are grouped in one pass by hashing their 
+         * normals and sorting each group by plane offset.
+         */
         void find_same_plane_facets(vector<vector<Facet_3D>>& sp_facets) const;
+        // precision for differences of point coordinates as large as the mesh points
+        const Point_3D::Measurement scaled_precision() const;
     };
 
 
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Winding_Number_3D.cpp
+ * Author: Jeffrey Davis
+ */
+
+#include "Winding_Number_3D.h"
+#include <cmath>
+#include "Mesh_3D.h"
+
+namespace VCAD_lib
+{
+    static const Point_3D::Measurement pi(3.14159265358979323846);
+
+    Winding_Number_3D::Winding_Number_3D(const Mesh_3D& mesh, const Measurement acc) :
+            accuracy(acc), coords(), tree(mesh.get_facet_tree()), clusters()
+    {
+        coords.reserve(9 * mesh.size());
+        Mesh_3D::const_point_iterator pts(mesh.point_begin());
+        for (Mesh_3D::const_facet_iterator it = mesh.facet_begin(); it != mesh.facet_end(); ++it)
+        {
+            const int indexes[3] = { it->get_p1_index(), it->get_p2_index(), it->get_p3_index() };
+            for (int i = 0; i < 3; ++i)
+            {
+                coords.push_back(pts[indexes[i]]->get_x());
+                coords.push_back(pts[indexes[i]]->get_y());
+                coords.push_back(pts[indexes[i]]->get_z());
+            }
+        }
+
+        // children are after their parent, so go backwards to have the
+        // children done before the parent
+        clusters.resize(tree.node_size());
+        for (int node = static_cast<int>(tree.node_size()) - 1; node >= 0; --node)
+        {
+            Cluster& cluster(clusters[node]);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                cluster.center[axis] = 0;
+                cluster.normal[axis] = 0;
+            }
+            cluster.area = 0;
+            if (tree.is_leaf(node))
+            {
+                for (vector<int>::const_iterator it = tree.leaf_begin(node); it != tree.leaf_end(node); ++it)
+                {
+                    const Measurement* p(&coords[9 * *it]);
+                    const Measurement u[3] = { p[3] - p[0], p[4] - p[1], p[5] - p[2] };
+                    const Measurement v[3] = { p[6] - p[0], p[7] - p[1], p[8] - p[2] };
+                    const Measurement n[3] = { (u[1] * v[2] - u[2] * v[1]) / 2,
+                            (u[2] * v[0] - u[0] * v[2]) / 2, (u[0] * v[1] - u[1] * v[0]) / 2 };
+                    const Measurement area(sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]));
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        cluster.normal[axis] += n[axis];
+                        cluster.center[axis] += area * (p[axis] + p[3 + axis] + p[6 + axis]) / 3;
+                    }
+                    cluster.area += area;
+                }
+            }
+            else
+            {
+                const Cluster& child1(clusters[tree.first_child(node)]);
+                const Cluster& child2(clusters[tree.second_child(node)]);
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    cluster.normal[axis] = child1.normal[axis] + child2.normal[axis];
+                    cluster.center[axis] = child1.area * child1.center[axis] + child2.area * child2.center[axis];
+                }
+                cluster.area = child1.area + child2.area;
+            }
+
+            const Point_3D box_min(tree.node_min(node));
+            const Point_3D box_max(tree.node_max(node));
+            const Measurement lower[3] = { box_min.get_x(), box_min.get_y(), box_min.get_z() };
+            const Measurement upper[3] = { box_max.get_x(), box_max.get_y(), box_max.get_z() };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (cluster.area > 0)
+                    cluster.center[axis] /= cluster.area;
+                else // facets do not have any area
+                    cluster.center[axis] = (lower[axis] + upper[axis]) / 2;
+            }
+            Measurement radius2(0);
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const Measurement d(max(cluster.center[axis] - lower[axis], upper[axis] - cluster.center[axis]));
+                radius2 += d * d;
+            }
+            cluster.radius = sqrt(radius2);
+        }
+    }
+
+    const Winding_Number_3D::Measurement Winding_Number_3D::winding_number(const Point_3D& p) const
+    {
+        if (clusters.empty())
+            return 0;
+
+        const Measurement pt[3] = { p.get_x(), p.get_y(), p.get_z() };
+        Measurement total(0);
+        vector<int> stack(1, 0);
+        while (!stack.empty())
+        {
+            const int node(stack.back());
+            stack.pop_back();
+            const Cluster& cluster(clusters[node]);
+            const Measurement d[3] = { cluster.center[0] - pt[0], cluster.center[1] - pt[1],
+                    cluster.center[2] - pt[2] };
+            const Measurement distance(sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]));
+            if (distance > accuracy * cluster.radius)
+            {
+                // far away, so the solid angle is about the area normal
+                // projected toward the point over the distance squared
+                total += (cluster.normal[0] * d[0] + cluster.normal[1] * d[1] +
+                        cluster.normal[2] * d[2]) / (distance * distance * distance);
+            }
+            else if (tree.is_leaf(node))
+            {
+                for (vector<int>::const_iterator it = tree.leaf_begin(node); it != tree.leaf_end(node); ++it)
+                    total += solid_angle(*it, pt);
+            }
+            else
+            {
+                stack.push_back(tree.second_child(node));
+                stack.push_back(tree.first_child(node));
+            }
+        }
+        return total / (4 * pi);
+    }
+
+    const Winding_Number_3D::Measurement Winding_Number_3D::exact_winding_number(const Point_3D& p) const
+    {
+        const Measurement pt[3] = { p.get_x(), p.get_y(), p.get_z() };
+        Measurement total(0);
+        for (int index = 0; index < static_cast<int>(coords.size() / 9); ++index)
+            total += solid_angle(index, pt);
+        return total / (4 * pi);
+    }
+
+    const Winding_Number_3D::Measurement Winding_Number_3D::solid_angle(const int index, const Measurement p[3]) const
+    {
+        // Van Oosterom and Strackee formula
+        const Measurement* f(&coords[9 * index]);
+        const Measurement a[3] = { f[0] - p[0], f[1] - p[1], f[2] - p[2] };
+        const Measurement b[3] = { f[3] - p[0], f[4] - p[1], f[5] - p[2] };
+        const Measurement c[3] = { f[6] - p[0], f[7] - p[1], f[8] - p[2] };
+        const Measurement a_length(sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]));
+        const Measurement b_length(sqrt(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]));
+        const Measurement c_length(sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]));
+        const Measurement determinant(a[0] * (b[1] * c[2] - b[2] * c[1]) -
+                a[1] * (b[0] * c[2] - b[2] * c[0]) + a[2] * (b[0] * c[1] - b[1] * c[0]));
+        const Measurement denominator(a_length * b_length * c_length +
+                (a[0] * b[0] + a[1] * b[1] + a[2] * b[2]) * c_length +
+                (b[0] * c[0] + b[1] * c[1] + b[2] * c[2]) * a_length +
+                (c[0] * a[0] + c[1] * a[1] + c[2] * a[2]) * b_length);
+        return 2 * atan2(determinant, denominator);
+    }
+}
+
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2017 Jeffrey Davis
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * File:   Winding_Number_3D.h
+ * Author: Jeffrey Davis
+ */
+
+#ifndef WINDING_NUMBER_3D_H
+#define WINDING_NUMBER_3D_H
+
+#include <vector>
+#include "Point_3D.h"
+#include "Facet_Tree_3D.h"
+
+using namespace std;
+
+namespace VCAD_lib
+{
+    class Mesh_3D;
+
+    /*
+     * Generalized winding number of a mesh: the sum of the solid angles of
+     * the facets seen from a point divided by 4 pi.  It is 1 inside and 0
+     * outside a closed mesh with the facet normals pointing out, and it
+     * changes smoothly near gaps and overlaps, so it still gives a useful
+     * inside test for meshes that are not closed.  A point on the surface
+     * has a value of about 0.5.
+     *
+     * winding_number uses the mesh facet tree.  A node that is far from the
+     * point compared to its size is treated as one facet with the summed
+     * area normal of its facets at their center, so only the nodes near the
+     * point are summed facet by facet.  accuracy is how many node radii
+     * away the point must be for a node to be treated this way.  Larger
+     * values are more accurate and slower.
+     *
+     * The object keeps its own copy of the facets and does not change when
+     * the mesh changes.
+     */
+    class Winding_Number_3D {
+    public:
+        typedef Point_3D::Measurement Measurement;
+
+        // exception safety: strong guarantee
+        explicit Winding_Number_3D(const Mesh_3D& mesh, const Measurement acc = 2);
+        // winding number of the mesh at p
+        // exception safety: strong guarantee
+        const Measurement winding_number(const Point_3D& p) const;
+        // winding number of the mesh at p summed over every facet
+        // exception safety: no throw
+        const Measurement exact_winding_number(const Point_3D& p) const;
+        // true if the winding number at p is more than 0.5
+        // exception safety: strong guarantee
+        const bool contains_point(const Point_3D& p) const { return winding_number(p) > 0.5; }
+    private:
+        // far field data for a tree node
+        struct Cluster {
+            Measurement center[3]; // center of the facets weighted by area
+            Measurement normal[3]; // sum of facet normals times facet areas
+            Measurement area;
+            Measurement radius;    // distance from center to the farthest box corner
+        };
+
+        Measurement accuracy;
+        vector<Measurement> coords; // x, y, z of the three points of each facet
+        Facet_Tree_3D tree;
+        vector<Cluster> clusters;   // one for each tree node
+
+        // solid angle of the facet at index seen from p
+        const Measurement solid_angle(const int index, const Measurement p[3]) const;
+    };
+}
+
+#endif /* WINDING_NUMBER_3D_H */
+
@@ -35,22 +35,30 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/CSG_Tree_3D.o \
 	${OBJECTDIR}/Facet.o \
 	${OBJECTDIR}/Facet_2D.o \
 	${OBJECTDIR}/Facet_3D.o \
+	${OBJECTDIR}/Facet_Tree_3D.o \
+	${OBJECTDIR}/Half_Edge_Mesh.o \
 	${OBJECTDIR}/Intersect_Meshes_2D.o \
 	${OBJECTDIR}/Intersect_Meshes_3D.o \
 	${OBJECTDIR}/Mesh_2D.o \
 	${OBJECTDIR}/Mesh_3D.o \
+	${OBJECTDIR}/Parallel_Queries.o \
 	${OBJECTDIR}/Point_2D.o \
 	${OBJECTDIR}/Point_3D.o \
+	${OBJECTDIR}/Point_Grid_3D.o \
+	${OBJECTDIR}/Point_Index.o \
 	${OBJECTDIR}/Simplify_Mesh_2D.o \
 	${OBJECTDIR}/Simplify_Mesh_3D.o \
+	${OBJECTDIR}/Transform_3D.o \
 	${OBJECTDIR}/VSCAD_Error.o \
 	${OBJECTDIR}/Valid_Mesh_2D.o \
 	${OBJECTDIR}/Valid_Mesh_3D.o \
 	${OBJECTDIR}/Vector_2D.o \
 	${OBJECTDIR}/Vector_3D.o \
+	${OBJECTDIR}/Winding_Number_3D.o \
 	${OBJECTDIR}/shapes.o \
 	${OBJECTDIR}/stl.o
 
@@ -59,8 +67,8 @@ OBJECTFILES= \
 CFLAGS=
 
 # CC Compiler Flags
-CCFLAGS=
-CXXFLAGS=
+CCFLAGS=-pthread
+CXXFLAGS=-pthread
 
 # Fortran Compiler Flags
 FFLAGS=
@@ -69,7 +77,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-pthread
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -79,6 +87,11 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libVCAD_lib.${CND_DLIB_EXT}: ${OBJECT
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.cc} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/libVCAD_lib.${CND_DLIB_EXT} ${OBJECTFILES} ${LDLIBSOPTIONS} -shared -fPIC
 
+${OBJECTDIR}/CSG_Tree_3D.o: CSG_Tree_3D.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/CSG_Tree_3D.o CSG_Tree_3D.cpp
+
 ${OBJECTDIR}/Facet.o: Facet.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -94,6 +107,16 @@ ${OBJECTDIR}/Facet_3D.o: Facet_3D.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Facet_3D.o Facet_3D.cpp
 
+${OBJECTDIR}/Facet_Tree_3D.o: Facet_Tree_3D.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Facet_Tree_3D.o Facet_Tree_3D.cpp
+
+${OBJECTDIR}/Half_Edge_Mesh.o: Half_Edge_Mesh.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Half_Edge_Mesh.o Half_Edge_Mesh.cpp
+
 ${OBJECTDIR}/Intersect_Meshes_2D.o: Intersect_Meshes_2D.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -114,6 +137,11 @@ ${OBJECTDIR}/Mesh_3D.o: Mesh_3D.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Mesh_3D.o Mesh_3D.cpp
 
+${OBJECTDIR}/Parallel_Queries.o: Parallel_Queries.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Parallel_Queries.o Parallel_Queries.cpp
+
 ${OBJECTDIR}/Point_2D.o: Point_2D.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -124,6 +152,16 @@ ${OBJECTDIR}/Point_3D.o: Point_3D.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Point_3D.o Point_3D.cpp
 
+${OBJECTDIR}/Point_Grid_3D.o: Point_Grid_3D.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Point_Grid_3D.o Point_Grid_3D.cpp
+
+${OBJECTDIR}/Point_Index.o: Point_Index.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Point_Index.o Point_Index.cpp
+
 ${OBJECTDIR}/Simplify_Mesh_2D.o: Simplify_Mesh_2D.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -134,6 +172,11 @@ ${OBJECTDIR}/Simplify_Mesh_3D.o: Simplify_Mesh_3D.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Simplify_Mesh_3D.o Simplify_Mesh_3D.cpp
 
+${OBJECTDIR}/Transform_3D.o: Transform_3D.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Transform_3D.o Transform_3D.cpp
+
 ${OBJECTDIR}/VSCAD_Error.o: VSCAD_Error.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -159,6 +202,11 @@ ${OBJECTDIR}/Vector_3D.o: Vector_3D.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Vector_3D.o Vector_3D.cpp
 
+${OBJECTDIR}/Winding_Number_3D.o: Winding_Number_3D.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -std=c++11 -fPIC  -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Winding_Number_3D.o Winding_Number_3D.cpp
+
 ${OBJECTDIR}/shapes.o: shapes.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -22,6 +22,7 @@
 #include <cstring>
 #include <memory>
 #include <sstream>
+#include <utility>
 #include "Point_3D.h"
 #include "Vector_3D.h"
 #include "Facet_3D.h"
@@ -109,6 +110,7 @@ namespace VCAD_lib
         trim_inplace(comment);
 
         Mesh_3D temp(mesh.get_precision()); // temporary mesh to store facets in case of error
+        temp.set_weld_points(mesh.get_weld_points());
 
         // read facets
         while (ifs >> line)
@@ -305,11 +307,10 @@ namespace VCAD_lib
         
         ifs.close();
         
-        mesh.clear();
-        for (Mesh_3D::const_iterator it = temp.cbegin(); it != temp.cend(); ++it)
-            mesh.push_back(*it);
-        
-        return temp.size();
+        // hand the facets to mesh instead of adding them again
+        const int num_read(temp.size());
+        mesh = move(temp);
+        return num_read;
     }
     
     const bool is_little_endian()
@@ -551,6 +552,7 @@ namespace VCAD_lib
         unsigned int num_facets = read_uint(ifs);
         
         Mesh_3D temp(mesh.get_precision()); // temporary mesh to hold facets
+        temp.set_weld_points(mesh.get_weld_points());
         ifs.peek();
         while (!ifs.eof())
         {
@@ -599,10 +601,10 @@ namespace VCAD_lib
             throw e;
         }
         
-        mesh.clear();
-        for (Mesh_3D::const_iterator it = temp.cbegin(); it != temp.cend(); ++it)
-            mesh.push_back(*it);
-        return temp.size();
+        // hand the facets to mesh instead of adding them again
+        const int num_read(temp.size());
+        mesh = move(temp);
+        return num_read;
     }
     
     const int read_stl_bin_cbo(Mesh_3D& mesh, const string& filename, string& comment,
@@ -625,6 +627,7 @@ namespace VCAD_lib
         unsigned int num_facets = read_uint_cbo(ifs);
 
         Mesh_3D temp(mesh.get_precision()); // temporary mesh to hold facets
+        temp.set_weld_points(mesh.get_weld_points());
         ifs.peek();
         while (!ifs.eof())
         {
@@ -673,10 +676,10 @@ namespace VCAD_lib
             throw e;
         }
 
-        mesh.clear();
-        for (Mesh_3D::const_iterator it = temp.cbegin(); it != temp.cend(); ++it)
-            mesh.push_back(*it);
-        return temp.size();
+        // hand the facets to mesh instead of adding them again
+        const int num_read(temp.size());
+        mesh = move(temp);
+        return num_read;
     }
     
     void write_stl(const Mesh_3D& mesh, const string& filename, 
@@ -722,7 +725,7 @@ namespace VCAD_lib
                 throw STL_Error("Error writing to file: " + filename);
         }
         
-        for (Mesh_3D::const_iterator it = mesh.begin(); it != mesh.end(); ++it)
+        for (Mesh_3D::const_view_iterator it = mesh.view_begin(); it != mesh.view_end(); ++it)
         {
             // write unit normal
             ofs << "  facet normal ";
@@ -767,19 +770,19 @@ namespace VCAD_lib
             ofs << "      vertex ";
             if (ofs.fail())
                 throw STL_Error("Error writing to file: " + filename);
-            ofs << it->get_point1()->get_x();
+            ofs << it->get_point1().get_x();
             if (ofs.fail())
                 throw STL_Error("Error writing to file: " + filename);
             ofs << ' ';
             if (ofs.fail())
                 throw STL_Error("Error writing to file: " + filename);
-            ofs << it->get_point1()->get_y();
+            ofs << it->get_point1().get_y();
             if (ofs.fail())
                 throw STL_Error("Error writing to file: " + filename);
             ofs << ' ';
             if (ofs.fail())
                 throw STL_Error("Error writing to file: " + filename);
-            ofs << it->get_point1()->get_z();
+            ofs << it->get_point1().get_z();
             if (ofs.fail())
                 throw STL_Error("Error writing to file: " + filename);
             ofs << endl;
@@ -790,19 +793,19 @@ namespace VCAD_lib
                 ofs << "      vertex ";
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point3()->get_x();
+                ofs << it->get_point3().get_x();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' ';
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point3()->get_y();
+                ofs << it->get_point3().get_y();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' ';
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point3()->get_z();
+                ofs << it->get_point3().get_z();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << endl;
@@ -811,19 +814,19 @@ namespace VCAD_lib
                 ofs << "      vertex ";
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point2()->get_x();
+                ofs << it->get_point2().get_x();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' ';
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point2()->get_y();
+                ofs << it->get_point2().get_y();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' '; 
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point2()->get_z();
+                ofs << it->get_point2().get_z();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << endl;
@@ -835,19 +838,19 @@ namespace VCAD_lib
                 ofs << "      vertex ";
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point2()->get_x();
+                ofs << it->get_point2().get_x();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' ';
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point2()->get_y();
+                ofs << it->get_point2().get_y();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' '; 
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point2()->get_z();
+                ofs << it->get_point2().get_z();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << endl;
@@ -856,19 +859,19 @@ namespace VCAD_lib
                 ofs << "      vertex ";
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point3()->get_x();
+                ofs << it->get_point3().get_x();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' ';
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point3()->get_y();
+                ofs << it->get_point3().get_y();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << ' ';
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
-                ofs << it->get_point3()->get_z();
+                ofs << it->get_point3().get_z();
                 if (ofs.fail())
                     throw STL_Error("Error writing to file: " + filename);
                 ofs << endl;
@@ -964,7 +967,7 @@ namespace VCAD_lib
         // write number of facets
         write_uint(ofs, mesh.size());
         
-        for (Mesh_3D::const_iterator it = mesh.begin(); it != mesh.end(); ++it)
+        for (Mesh_3D::const_view_iterator it = mesh.view_begin(); it != mesh.view_end(); ++it)
         {
             // write unit normal vector
             if (zero_unv)
@@ -980,31 +983,31 @@ namespace VCAD_lib
                 write_float(ofs, float(it->get_unv().get_z()));
             }
             // write point 1
-            write_float(ofs, float(it->get_point1()->get_x()));
-            write_float(ofs, float(it->get_point1()->get_y()));
-            write_float(ofs, float(it->get_point1()->get_z()));
+            write_float(ofs, float(it->get_point1().get_x()));
+            write_float(ofs, float(it->get_point1().get_y()));
+            write_float(ofs, float(it->get_point1().get_z()));
             
             if (clockwise_order) // swap points two and three
             {
                 // write point 3
-                write_float(ofs, float(it->get_point3()->get_x()));
-                write_float(ofs, float(it->get_point3()->get_y()));
-                write_float(ofs, float(it->get_point3()->get_z()));
+                write_float(ofs, float(it->get_point3().get_x()));
+                write_float(ofs, float(it->get_point3().get_y()));
+                write_float(ofs, float(it->get_point3().get_z()));
                 // write point 2
-                write_float(ofs, float(it->get_point2()->get_x()));
-                write_float(ofs, float(it->get_point2()->get_y()));
-                write_float(ofs, float(it->get_point2()->get_z()));
+                write_float(ofs, float(it->get_point2().get_x()));
+                write_float(ofs, float(it->get_point2().get_y()));
+                write_float(ofs, float(it->get_point2().get_z()));
             }
             else
             {
                 // write point 2
-                write_float(ofs, float(it->get_point2()->get_x()));
-                write_float(ofs, float(it->get_point2()->get_y()));
-                write_float(ofs, float(it->get_point2()->get_z()));
+                write_float(ofs, float(it->get_point2().get_x()));
+                write_float(ofs, float(it->get_point2().get_y()));
+                write_float(ofs, float(it->get_point2().get_z()));
                 // write point 3
-                write_float(ofs, float(it->get_point3()->get_x()));
-                write_float(ofs, float(it->get_point3()->get_y()));
-                write_float(ofs, float(it->get_point3()->get_z()));
+                write_float(ofs, float(it->get_point3().get_x()));
+                write_float(ofs, float(it->get_point3().get_y()));
+                write_float(ofs, float(it->get_point3().get_z()));
             }
             // write attribute
             write_short(ofs, attribute);
@@ -1049,7 +1052,7 @@ namespace VCAD_lib
         // write number of facets
         write_uint_cbo(ofs, mesh.size());
         
-        for (Mesh_3D::const_iterator it = mesh.begin(); it != mesh.end(); ++it)
+        for (Mesh_3D::const_view_iterator it = mesh.view_begin(); it != mesh.view_end(); ++it)
         {
             // write unit normal vector
             if (zero_unv)
@@ -1065,31 +1068,31 @@ namespace VCAD_lib
                 write_float_cbo(ofs, float(it->get_unv().get_z()));
             }
             // write point 1
-            write_float_cbo(ofs, float(it->get_point1()->get_x()));
-            write_float_cbo(ofs, float(it->get_point1()->get_y()));
-            write_float_cbo(ofs, float(it->get_point1()->get_z()));
+            write_float_cbo(ofs, float(it->get_point1().get_x()));
+            write_float_cbo(ofs, float(it->get_point1().get_y()));
+            write_float_cbo(ofs, float(it->get_point1().get_z()));
             
             if (clockwise_order) // swap points two and three
             {
                 // write point 3
-                write_float_cbo(ofs, float(it->get_point3()->get_x()));
-                write_float_cbo(ofs, float(it->get_point3()->get_y()));
-                write_float_cbo(ofs, float(it->get_point3()->get_z()));
+                write_float_cbo(ofs, float(it->get_point3().get_x()));
+                write_float_cbo(ofs, float(it->get_point3().get_y()));
+                write_float_cbo(ofs, float(it->get_point3().get_z()));
                 // write point 2
-                write_float_cbo(ofs, float(it->get_point2()->get_x()));
-                write_float_cbo(ofs, float(it->get_point2()->get_y()));
-                write_float_cbo(ofs, float(it->get_point2()->get_z()));
+                write_float_cbo(ofs, float(it->get_point2().get_x()));
+                write_float_cbo(ofs, float(it->get_point2().get_y()));
+                write_float_cbo(ofs, float(it->get_point2().get_z()));
             }
             else
             {
                 // write point 2
-                write_float_cbo(ofs, float(it->get_point2()->get_x()));
-                write_float_cbo(ofs, float(it->get_point2()->get_y()));
-                write_float_cbo(ofs, float(it->get_point2()->get_z()));
+                write_float_cbo(ofs, float(it->get_point2().get_x()));
+                write_float_cbo(ofs, float(it->get_point2().get_y()));
+                write_float_cbo(ofs, float(it->get_point2().get_z()));
                 // write point 3
-                write_float_cbo(ofs, float(it->get_point3()->get_x()));
-                write_float_cbo(ofs, float(it->get_point3()->get_y()));
-                write_float_cbo(ofs, float(it->get_point3()->get_z()));
+                write_float_cbo(ofs, float(it->get_point3().get_x()));
+                write_float_cbo(ofs, float(it->get_point3().get_y()));
+                write_float_cbo(ofs, float(it->get_point3().get_z()));
             }
             // write attribute
             write_short_cbo(ofs, attribute);